@@ -0,0 +1,363 @@
+// Copyright 2010, 2017 William Rummler (w.a.rummler@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <http://www.gnu.org/licenses/>.
+
+// This file contains Bertsekas's auction algorithm with epsilon-scaling, as an
+// alternative engine for large dense problems that can bid on many cores. See
+// D. P. Bertsekas, "The auction algorithm for assignment and other network flow
+// problems: A tutorial" (Interfaces 20(4), 1990).
+//
+// Rows are persons and columns are objects. Each round, every unassigned person
+// bids for the object of best value -c[i][j] - price[j] (Jacobi bidding), and
+// each object goes to its highest bidder at that bidder's price. The bids of a
+// round are computed in parallel, reduced per object with atomic compare-and-
+// swap maxima, and then resolved by one thread while the others wait at a
+// barrier.
+//
+// Costs are scaled by n + 1, so that the final epsilon of one puts the matching
+// within n of the optimum on the scaled costs, which is less than the gap n + 1
+// between any two distinct (scaled) matching costs. The output is therefore
+// exact. Each scaling phase divides epsilon by AUCTION_SCALE, restarting the
+// auction from the prices of the previous phase. There are thus O(log(nC))
+// phases for costs spanning a range of C, which suits this engine to wide cost
+// ranges; the stages of the Hungarian method, by contrast, each take at most n
+// dual updates whatever the range, so scaling its costs only adds stages.
+
+#include "auction_assignment.h"
+#include <cstdlib>
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define AUCTION_SCALE 4
+
+// The same zero-based conventions as hungarian_method.cc: V={0,...,n-1},
+// U={n,...,2n-1}, and a negative int as a "blank" value.
+enum
+{
+    blank = -1
+};
+
+// A reusable barrier for the threads of one auction.
+struct auction_barrier
+{
+    std::mutex lock;
+    std::condition_variable cv;
+    int num_threads;
+    int num_waiting;
+    unsigned generation;
+};
+
+static void barrier_wait(auction_barrier *b)
+{
+    std::unique_lock<std::mutex> guard(b->lock);
+    unsigned generation = b->generation;
+    if (++b->num_waiting == b->num_threads)
+    {
+        b->num_waiting = 0;
+        ++b->generation;
+        b->cv.notify_all();
+        return;
+    }
+
+    while (generation == b->generation)
+    {
+        b->cv.wait(guard);
+    }
+}
+
+// This structure type holds all data pertinent to one auction.
+struct auction_data
+{
+    const int *c;
+    int n;
+    int num_threads;
+
+    int64_t eps;
+    int64_t *price;   // each object's price, on the scaled costs
+    int *owner;       // each object's person, or blank
+    int *object;      // each person's object, or blank
+    int *bidders;     // the unassigned persons bidding this round
+    int *next;        // the persons left unassigned by this round
+    int *bid_object;  // the object of each bidder's bid
+    int64_t *bid;     // the amount of each bidder's bid
+    int num_bidders;
+    bool done;
+
+    std::vector<std::atomic<int64_t> > *best; // each object's highest bid
+    std::vector<std::atomic<int> > *winner;   // the person who made it
+    auction_barrier barrier;
+};
+
+// Computes the bids of bidders [begin, end), and raises the best bid of each
+// object bid for.
+static void auction_bid(auction_data *au, int begin, int end)
+{
+    std::vector<std::atomic<int64_t> > &best = *au->best;
+    int k, i, j, j1;
+    int64_t scale = au->n + 1, value, w1, w2, amount, current;
+    for (k = begin; k < end; ++k)
+    {
+        i = au->bidders[k];
+        j1 = blank;
+        w1 = w2 = std::numeric_limits<int64_t>::min();
+        for (j = 0; j < au->n; ++j)
+        {
+            value = -scale * au->c[i * au->n + j] - au->price[j];
+            if (value > w1)
+            {
+                w2 = w1;
+                w1 = value;
+                j1 = j;
+            }
+            else if (value > w2)
+            {
+                w2 = value;
+            }
+        }
+
+        // Bid the price at which j1 would be no better than the second best
+        // object, plus epsilon.
+        amount = au->price[j1] + (w1 - w2) + au->eps;
+        au->bid_object[k] = j1;
+        au->bid[k] = amount;
+        current = best[j1].load(std::memory_order_relaxed);
+        while (amount > current &&
+               !best[j1].compare_exchange_weak(current, amount));
+    }
+}
+
+// Lets the first of the highest bidders on each object, among [begin, end),
+// claim it.
+static void auction_claim(auction_data *au, int begin, int end)
+{
+    int k, unclaimed;
+    for (k = begin; k < end; ++k)
+    {
+        if (au->bid[k] == (*au->best)[au->bid_object[k]].load())
+        {
+            unclaimed = blank;
+            (*au->winner)[au->bid_object[k]].compare_exchange_strong(
+                unclaimed, au->bidders[k]);
+        }
+    }
+}
+
+// Starts a scaling phase, with every person unassigned.
+static void auction_start_phase(auction_data *au)
+{
+    int i;
+    for (i = 0; i < au->n; ++i)
+    {
+        au->owner[i] = au->object[i] = blank;
+        au->bidders[i] = i;
+    }
+
+    au->num_bidders = au->n;
+}
+
+// Awards each object bid for to its winner, and gathers the next round's
+// bidders: the losers, and the persons whose objects were taken. Advances to
+// the next phase, or finishes, when no bidder remains.
+static void auction_resolve(auction_data *au)
+{
+    std::vector<std::atomic<int64_t> > &best = *au->best;
+    std::vector<std::atomic<int> > &winner = *au->winner;
+    int k, i, j, num_next = 0, *swap;
+    for (k = 0; k < au->num_bidders; ++k)
+    {
+        i = au->bidders[k];
+        j = au->bid_object[k];
+        if (winner[j].load() != i)
+        {
+            au->next[num_next++] = i;
+            continue;
+        }
+
+        if (au->owner[j] != blank)
+        {
+            au->object[au->owner[j]] = blank;
+            au->next[num_next++] = au->owner[j];
+        }
+
+        au->owner[j] = i;
+        au->object[i] = j;
+        au->price[j] = best[j].load();
+    }
+
+    for (k = 0; k < au->num_bidders; ++k)
+    {
+        j = au->bid_object[k];
+        best[j].store(std::numeric_limits<int64_t>::min());
+        winner[j].store(blank);
+    }
+
+    swap = au->bidders;
+    au->bidders = au->next;
+    au->next = swap;
+    au->num_bidders = num_next;
+    if (num_next == 0)
+    {
+        if (au->eps == 1)
+        {
+            au->done = true;
+        }
+        else
+        {
+            au->eps = au->eps / AUCTION_SCALE > 1 ? au->eps / AUCTION_SCALE : 1;
+            auction_start_phase(au);
+        }
+    }
+}
+
+// The body of thread w: bid and claim for its share of each round's bidders,
+// with thread zero resolving each round.
+static void auction_worker(auction_data *au, int w)
+{
+    int begin, end;
+    for (;;)
+    {
+        begin = (int)((int64_t)au->num_bidders * w / au->num_threads);
+        end = (int)((int64_t)au->num_bidders * (w + 1) / au->num_threads);
+        auction_bid(au, begin, end);
+        barrier_wait(&au->barrier);
+        auction_claim(au, begin, end);
+        barrier_wait(&au->barrier);
+        if (w == 0)
+        {
+            auction_resolve(au);
+        }
+
+        barrier_wait(&au->barrier);
+        if (au->done)
+        {
+            return;
+        }
+    }
+}
+
+// Input:
+//
+// mate points to a memory block of at least 2 * n ints, and c to the n*n cost
+// matrix, both as described for hungarian_method().
+//
+// num_threads is the number of threads to bid with, including the calling
+// thread. Zero or less selects one per hardware thread.
+//
+// Output:
+//
+// Fills mate with an optimal matching, where V={0,...,n-1} and U={n,...,2n-1},
+// and returns true. Returns false, leaving mate untouched, if memory is
+// unavailable.
+bool auction_assignment(int *mate, const int *c, int n, int num_threads)
+{
+    int i, j, w;
+    if (n == 1)
+    {
+        mate[0] = 1;
+        mate[1] = 0;
+    }
+
+    if (n <= 1)
+    {
+        return true;
+    }
+
+    auction_data au;
+    size_t size = 2 * (size_t)n * sizeof(int64_t) + 5 * (size_t)n * sizeof(int);
+    void *block = malloc(size);
+    if (!block)
+    {
+        return false;
+    }
+
+    // The 64-bit arrays come first so that they inherit the block's alignment.
+    au.c = c;
+    au.n = n;
+    au.price = (int64_t *)block;
+    au.bid = au.price + n;
+    au.owner = (int *)(au.bid + n);
+    au.object = au.owner + n;
+    au.bidders = au.object + n;
+    au.next = au.bidders + n;
+    au.bid_object = au.next + n;
+
+    std::vector<std::atomic<int64_t> > best(n);
+    std::vector<std::atomic<int> > winner(n);
+    au.best = &best;
+    au.winner = &winner;
+
+    // The initial epsilon is half the range of the scaled costs.
+    int lo = c[0], hi = c[0];
+    for (i = 0; i < n * n; ++i)
+    {
+        lo = c[i] < lo ? c[i] : lo;
+        hi = c[i] > hi ? c[i] : hi;
+    }
+
+    au.eps = ((int64_t)hi - lo) * (n + 1) / 2;
+    au.eps = au.eps > 1 ? au.eps : 1;
+    for (j = 0; j < n; ++j)
+    {
+        au.price[j] = 0;
+        best[j].store(std::numeric_limits<int64_t>::min());
+        winner[j].store(blank);
+    }
+
+    auction_start_phase(&au);
+    au.done = false;
+
+    if (num_threads <= 0)
+    {
+        num_threads = (int)std::thread::hardware_concurrency();
+    }
+
+    if (num_threads > n)
+    {
+        num_threads = n;
+    }
+
+    if (num_threads < 1)
+    {
+        num_threads = 1;
+    }
+
+    au.num_threads = num_threads;
+    au.barrier.num_threads = num_threads;
+    au.barrier.num_waiting = 0;
+    au.barrier.generation = 0;
+    std::vector<std::thread> threads;
+    for (w = 1; w < num_threads; ++w)
+    {
+        threads.push_back(std::thread(auction_worker, &au, w));
+    }
+
+    auction_worker(&au, 0);
+    for (w = 0; w < (int)threads.size(); ++w)
+    {
+        threads[w].join();
+    }
+
+    for (i = 0; i < n; ++i)
+    {
+        mate[i] = n + au.object[i];
+        mate[n + au.object[i]] = i;
+    }
+
+    free(block);
+    return true;
+}
@@ -0,0 +1,21 @@
+// Copyright 2010, 2017 William Rummler (w.a.rummler@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef AUCTION_ASSIGNMENT_H
+#define AUCTION_ASSIGNMENT_H
+
+bool auction_assignment(int *, const int *, int, int);
+
+#endif
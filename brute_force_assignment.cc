@@ -12,97 +12,139 @@
 // You should have received a copy of the GNU General Public License along with
 // this program. If not, see <http://www.gnu.org/licenses/>.
 
+// This file contains an exhaustive solver for the assignment problem, used to
+// verify the other solvers of this package on small problems. It searches the
+// n! assignments depth first, assigning rows in order, and carries the cost of
+// each partial assignment down the search so that every extension costs O(1).
+//
+// The search is pruned by branch and bound. A partial assignment of rows 0 to
+// i-1 cannot be extended to anything cheaper than its cost plus the sum of the
+// row minima of rows i to n-1, so it is abandoned when that bound is no less
+// than the cost of the best assignment found. The columns of each row are tried
+// in order of increasing cost, so that good assignments are found early and so
+// that, once one column fails the bound, every later column does too.
+//
+// The search space is split by the columns assigned to the first BF_SPLIT rows,
+// and the threads take these prefixes in turn, sharing the best cost found. All
+// state is local to a call, in arrays of fixed size, so that any number of
+// calls may run concurrently.
+
 #include "brute_force_assignment.h"
-#include <cstdlib>
-#include <cstring>
-#include <limits.h>
-
-// rho[] is an array used by the function perm_lex_successor() found below. It is
-// declared and maintained globally in order to be efficiently re-used by
-// numerous successive calls to that function.
-static int *rho;
-
-// This function is registered with atexit() in order to free any memory
-// allocated for rho[] at program's end.
-static void rho_free(void)
+#include <stdint.h>
+#include <atomic>
+#include <limits>
+#include <thread>
+#include <vector>
+
+// The number of rows whose columns define the prefix taken by a thread.
+#define BF_SPLIT 2
+
+// The problem shared by all threads of one search.
+struct bf_problem
 {
-    if (rho)
-    {
-        free(rho);
-    }
-}
+    const int *c;
+    int n;
 
-// An implementation of:
-//
-// Kreher & Stinson "Combinatorial Algorithms: Generation, Enumeration, and
-// Search" Algorithm 2.14
-//
-// Generates the lexicographic successor of the given permutation. Some lines are
-// adjusted for zero-based indexing. Such lines are indicated.
-static int *perm_lex_successor(int n, int *pi)
+    // Each row's columns, by increasing cost, and the sum of the minima of rows
+    // i to n-1 for each i.
+    int order[brute_force_max_n * brute_force_max_n];
+    int64_t bound[brute_force_max_n + 1];
+
+    int num_prefixes; // n^BF_SPLIT, invalid prefixes included
+    std::atomic<int> next_prefix;
+    std::atomic<int64_t> best_cost;
+};
+
+// The state of one thread's search.
+struct bf_search
 {
-    static int m;
-    int h, i, j, t, *p;
-    i = n - 2; // adjusted
-    while (i >= 0 && pi[i] > pi[i + 1]) // adjusted
-    {
-        --i;
-    }
+    bf_problem *p;
+    uint64_t used; // the columns assigned so far
+    int perm[brute_force_max_n];
+    int best_perm[brute_force_max_n];
+    int64_t best_cost; // the cost of best_perm, if it was found by this thread
+};
 
-    if (i < 0) // adjusted
+// Extends the partial assignment of rows 0 to i-1, of the given cost, in every
+// way that may improve on the best assignment found.
+static void bf_descend(bf_search *s, int i, int64_t cost)
+{
+    bf_problem *p = s->p;
+    int j, k, n = p->n;
+    int64_t next;
+    if (i == n)
     {
-        return NULL;
+        // The shared best cost only decreases, one improvement at a time.
+        int64_t best = p->best_cost.load(std::memory_order_relaxed);
+        if (cost < s->best_cost)
+        {
+            s->best_cost = cost;
+            for (k = 0; k < n; ++k)
+            {
+                s->best_perm[k] = s->perm[k];
+            }
+        }
+
+        while (cost < best && !p->best_cost.compare_exchange_weak(best, cost))
+        {
+        }
+
+        return;
     }
 
-    // BEGIN: memory management for rho[] (see declaration above)
-    if (m < n)
+    for (k = 0; k < n; ++k)
     {
-        if (m == 0)
+        j = p->order[i * n + k];
+        if (s->used >> j & 1)
         {
-            atexit(rho_free);
+            continue;
         }
 
-        p = (int *)realloc(rho, (m = n) * sizeof(*p));
-        if (!p)
+        next = cost + p->c[i * n + j];
+        if (next + p->bound[i + 1]
+            >= p->best_cost.load(std::memory_order_relaxed))
         {
-            return NULL;
+            break;
         }
 
-        rho = p;
+        s->used |= (uint64_t)1 << j;
+        s->perm[i] = j;
+        bf_descend(s, i + 1, next);
+        s->used &= ~((uint64_t)1 << j);
     }
-    // END: memory management for rho[]
+}
 
-    j = n - 1; // adjusted
-    while (pi[j] < pi[i])
+// Searches the prefixes taken in turn by one thread.
+static void bf_worker(bf_search *s)
+{
+    bf_problem *p = s->p;
+    int i, j, t, k, n = p->n, depth = n < BF_SPLIT ? n : BF_SPLIT;
+    int64_t cost;
+    while ((t = p->next_prefix.fetch_add(1)) < p->num_prefixes)
     {
-        --j;
-    }
+        // Prefix t assigns row i to column (t / n^i) % n, for i < depth.
+        s->used = 0;
+        cost = 0;
+        for (i = 0, k = t; i < depth; ++i, k /= n)
+        {
+            j = k % n;
+            if (s->used >> j & 1)
+            {
+                break;
+            }
 
-    t = pi[j];
-    pi[j] = pi[i];
-    pi[i] = t;
-    for (h = i + 1; h < n; ++h) // adjusted
-    {
-        rho[h] = pi[h];
-    }
+            s->used |= (uint64_t)1 << j;
+            s->perm[i] = j;
+            cost += p->c[i * n + j];
+        }
 
-    for (h = i + 1; h < n; ++h) // adjusted
-    {
-        pi[h] = rho[n + i - h]; // adjusted
+        if (i == depth && cost + p->bound[depth] < p->best_cost.load())
+        {
+            bf_descend(s, depth, cost);
+        }
     }
-
-    return pi;
 }
 
-// This function uses an exhaustive "brute force" search over all possible
-// matchings to solve the assignment problem defined by the weighted complete
-// bipartite graph G=(V,U,E) which, in turn, is implicitly defined by the cost
-// matrix c given as an argument to this function.
-//
-// Specifically, it searches all n! permutations of {0,...,n-1} where n=|V|=|U|
-// and \pi_i is the i-th element of the permutation \pi, and vertex i from V is
-// assigned to vertex \pi_i from U.
-//
 // Input:
 //
 // mate points to a memory block of at least 2 * n ints. It is used to represent
@@ -113,54 +155,129 @@ static int *perm_lex_successor(int n, int *pi)
 // graph G=(V,U,E). The left and right indices respectively comprise vertex
 // labels from V and U.
 //
-// n is the size of V and the size of U.
+// n is the size of V and the size of U, at most brute_force_max_n.
+//
+// num_threads is the number of threads to search with, including the calling
+// thread, or zero or less for one per hardware thread.
 //
 // Output:
 //
-// Returns mate filled with the correct values to represent the solution
-// matching, where V={0,...,n-1} and U={n,...,2n-1}. An edge (v,u) is part of the
-// matching if and only if (v,mate[v])=(mate[u],u).
-void brute_force_assignment(int *mate, int *c, int n)
+// Returns false, with mate untouched, if n exceeds brute_force_max_n. Otherwise
+// fills mate with a minimum cost matching, where V={0,...,n-1} and U={n,...,
+// 2n-1}, and returns true. An edge (v,u) is part of the matching if and only if
+// (v,mate[v])=(mate[u],u). Which of several minimum cost matchings is returned
+// may depend on the timing of the threads.
+bool brute_force_assignment(int *mate, const int *c, int n, int num_threads)
 {
-    // Allocate temporary storage for exhaustive search.
-    int best_cost, current_cost;
-    int *best_perm, *current_perm;
-    if (!(best_perm = (int *)malloc(n * sizeof(*best_perm))) ||
-        !(current_perm = (int *)malloc(n * sizeof(*current_perm))))
+    if (n < 0 || n > brute_force_max_n)
     {
-        return;
+        return false;
+    }
+
+    // Order each row's columns by increasing cost, and sum the row minima.
+    int i, j, k, t, w;
+    bf_problem p;
+    p.c = c;
+    p.n = n;
+    p.bound[n] = 0;
+    for (i = n - 1; i >= 0; --i)
+    {
+        int *order = p.order + i * n;
+        for (j = 0; j < n; ++j)
+        {
+            for (k = j; k > 0 && c[i * n + order[k - 1]] > c[i * n + j]; --k)
+            {
+                order[k] = order[k - 1];
+            }
+
+            order[k] = j;
+        }
+
+        p.bound[i] = p.bound[i + 1] + c[i * n + order[0]];
     }
 
-    // Initialize the current permutation data structure with the
-    // lexicographically first permutation [0,...,n-1].
-    int i;
+    // The greedy assignment, taking each row's cheapest free column, is the
+    // best found before the search starts.
+    bf_search greedy;
+    uint64_t used = 0;
+    greedy.best_cost = 0;
     for (i = 0; i < n; ++i)
     {
-        current_perm[i] = i;
+        for (k = 0; used >> p.order[i * n + k] & 1; ++k)
+        {
+        }
+
+        j = p.order[i * n + k];
+        used |= (uint64_t)1 << j;
+        greedy.best_perm[i] = j;
+        greedy.best_cost += c[i * n + j];
     }
 
-    // Search over all n! permutations.
-    best_cost = INT_MAX;
-    do
+    for (p.num_prefixes = 1, i = 0; i < BF_SPLIT && i < n; ++i)
+    {
+        p.num_prefixes *= n;
+    }
+
+    p.next_prefix = 0;
+    p.best_cost = greedy.best_cost;
+
+    if (num_threads <= 0)
     {
-        current_cost = 0;
-        for (i = 0; i < n; ++i)
+        num_threads = (int)std::thread::hardware_concurrency();
+    }
+
+    if (num_threads > p.num_prefixes)
+    {
+        num_threads = p.num_prefixes;
+    }
+
+    if (num_threads < 1)
+    {
+        num_threads = 1;
+    }
+
+    // Each thread records only the assignments better than any it knew of, so
+    // the best of the threads' own, falling back on the greedy one, is optimal.
+    std::vector<bf_search> search(num_threads);
+    std::vector<std::thread> threads;
+    for (w = 0; w < num_threads; ++w)
+    {
+        search[w].p = &p;
+        search[w].best_cost = std::numeric_limits<int64_t>::max();
+    }
+
+    for (w = 1; w < num_threads; ++w)
+    {
+        threads.push_back(std::thread(bf_worker, &search[w]));
+    }
+
+    bf_worker(&search[0]);
+    const bf_search *best = &greedy;
+    for (w = 0; w < num_threads; ++w)
+    {
+        if (w > 0)
         {
-            current_cost += c[i * n + current_perm[i]];
+            threads[w - 1].join();
         }
-        if (current_cost < best_cost)
+
+        if (search[w].best_cost < best->best_cost)
         {
-            best_cost = current_cost;
-            memcpy(best_perm, current_perm, n * sizeof(*current_perm));
+            best = &search[w];
         }
-    } while (perm_lex_successor(n, current_perm));
+    }
 
     // Translate the best permutation into mate[].
-    int v, u;
-    for (v = 0; v < n; ++v)
+    for (t = 0; t < n; ++t)
     {
-        u = n + best_perm[v];
-        mate[v] = u;
-        mate[u] = v;
+        mate[t] = n + best->best_perm[t];
+        mate[n + best->best_perm[t]] = t;
     }
+
+    return true;
+}
+
+// As above, on a single thread. Fills mate as hungarian_method() does.
+void brute_force_assignment(int *mate, int *c, int n)
+{
+    brute_force_assignment(mate, c, n, 1);
 }
@@ -15,6 +15,13 @@
 #ifndef BRUTE_FORCE_ASSIGNMENT_H
 #define BRUTE_FORCE_ASSIGNMENT_H
 
+// The greatest n that brute_force_assignment() solves.
+enum
+{
+    brute_force_max_n = 32
+};
+
 void brute_force_assignment(int *, int *, int);
+bool brute_force_assignment(int *, const int *, int, int);
 
 #endif
@@ -0,0 +1,366 @@
+// Copyright 2010, 2017 William Rummler (w.a.rummler@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <http://www.gnu.org/licenses/>.
+
+// This file contains a batched front end to hungarian_method() for workloads of
+// many small, independent problems, where per-call overhead would otherwise
+// dominate. Each worker thread allocates one workspace for the largest problem
+// in the batch and solves its share of problems with it. Problems are dealt out
+// to the workers in contiguous ranges, and a worker that exhausts its own range
+// steals the back half of another's, which balances batches of uneven sizes.
+
+#include "hm_batch.h"
+#include "hungarian_method.h"
+#include <cstdlib>
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// A range [begin, end) of problem indices, packed into one atomic word so that
+// its owner and any thieves can update it with a single compare-and-swap.
+struct hm_batch_range
+{
+    std::atomic<uint64_t> bounds;
+};
+
+static uint64_t range_pack(uint32_t begin, uint32_t end)
+{
+    return (uint64_t)begin << 32 | end;
+}
+
+static uint32_t range_begin(uint64_t bounds)
+{
+    return (uint32_t)(bounds >> 32);
+}
+
+static uint32_t range_end(uint64_t bounds)
+{
+    return (uint32_t)bounds;
+}
+
+// Takes the first index of r into *k, as its owner does. Returns false if r is
+// empty.
+static bool range_pop(hm_batch_range *r, int *k)
+{
+    uint64_t b = r->bounds.load();
+    while (range_begin(b) < range_end(b))
+    {
+        if (r->bounds.compare_exchange_weak(
+                b, range_pack(range_begin(b) + 1, range_end(b))))
+        {
+            *k = (int)range_begin(b);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Moves the back half of victim, rounded up, into the empty range thief.
+// Returns false if victim is empty.
+static bool range_steal(hm_batch_range *victim, hm_batch_range *thief)
+{
+    uint32_t begin, end, mid;
+    uint64_t b = victim->bounds.load();
+    while ((begin = range_begin(b)) < (end = range_end(b)))
+    {
+        mid = begin + (end - begin) / 2;
+        if (victim->bounds.compare_exchange_weak(b, range_pack(begin, mid)))
+        {
+            thief->bounds.store(range_pack(mid, end));
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// The problems of one batch, given either as arrays of pointers or packed.
+template <typename T>
+struct hm_batch_job
+{
+    int count;
+    int *const *mate;
+    const T *const *c;
+    const int *n;
+
+    // For packed batches, problem k's costs begin at packed_c + c_offset[k]
+    // and its mate at packed_mate + mate_offset[k].
+    int *packed_mate;
+    const T *packed_c;
+    const size_t *c_offset;
+    const size_t *mate_offset;
+
+    int max_n;
+    std::vector<hm_batch_range> *ranges;
+    std::atomic<bool> failed;
+};
+
+template <typename T>
+static void hm_batch_solve_one(hm_batch_job<T> *job, hm_workspace *ws, int k)
+{
+    if (job->c)
+    {
+        hungarian_method(ws, job->mate[k], job->c[k], job->n[k]);
+    }
+    else
+    {
+        hungarian_method(ws, job->packed_mate + job->mate_offset[k],
+                         job->packed_c + job->c_offset[k], job->n[k]);
+    }
+}
+
+// The body of worker w: solve from its own range, then steal until every range
+// is empty.
+template <typename T>
+static void hm_batch_worker(hm_batch_job<T> *job, int w)
+{
+    std::vector<hm_batch_range> &ranges = *job->ranges;
+    int k, v, num_workers = (int)ranges.size();
+    hm_workspace *ws = hm_workspace_create(job->max_n);
+    if (!ws)
+    {
+        job->failed = true;
+        return;
+    }
+
+    for (;;)
+    {
+        while (range_pop(&ranges[w], &k))
+        {
+            hm_batch_solve_one(job, ws, k);
+        }
+
+        for (v = 1; v < num_workers; ++v)
+        {
+            if (range_steal(&ranges[(w + v) % num_workers], &ranges[w]))
+            {
+                break;
+            }
+        }
+
+        if (v == num_workers)
+        {
+            break;
+        }
+    }
+
+    hm_workspace_free(ws);
+}
+
+// Runs job on num_threads workers, the calling thread included.
+template <typename T>
+static bool hm_batch_run(hm_batch_job<T> *job, int num_threads)
+{
+    int k, w;
+    job->max_n = 0;
+    for (k = 0; k < job->count; ++k)
+    {
+        if (job->n[k] > job->max_n)
+        {
+            job->max_n = job->n[k];
+        }
+    }
+
+    if (num_threads <= 0)
+    {
+        num_threads = (int)std::thread::hardware_concurrency();
+    }
+
+    if (num_threads > job->count)
+    {
+        num_threads = job->count;
+    }
+
+    if (num_threads < 1)
+    {
+        num_threads = 1;
+    }
+
+    // Deal out equal contiguous ranges; stealing evens out the rest.
+    std::vector<hm_batch_range> ranges(num_threads);
+    for (w = 0; w < num_threads; ++w)
+    {
+        ranges[w].bounds = range_pack(
+            (uint32_t)((int64_t)job->count * w / num_threads),
+            (uint32_t)((int64_t)job->count * (w + 1) / num_threads));
+    }
+
+    job->ranges = &ranges;
+    job->failed = false;
+    std::vector<std::thread> threads;
+    for (w = 1; w < num_threads; ++w)
+    {
+        threads.push_back(std::thread(hm_batch_worker<T>, job, w));
+    }
+
+    hm_batch_worker(job, 0);
+    for (w = 0; w < (int)threads.size(); ++w)
+    {
+        threads[w].join();
+    }
+
+    return !job->failed;
+}
+
+// Input:
+//
+// count is the number of problems in the batch.
+//
+// mate[k], c[k], and n[k] describe problem k exactly as the arguments of
+// hungarian_method() do.
+//
+// num_threads is the number of threads to solve with, including the calling
+// thread. Zero or less selects one per hardware thread.
+//
+// Output:
+//
+// Fills each mate[k] as hungarian_method() does. Returns false if memory for a
+// worker's workspace was unavailable, in which case the problems that worker
+// would have solved are left untouched, unless stolen by another worker.
+template <typename T>
+bool hungarian_method_batch(int count, int *const *mate, const T *const *c,
+                            const int *n, int num_threads)
+{
+    hm_batch_job<T> job;
+    job.count = count;
+    job.mate = mate;
+    job.c = c;
+    job.n = n;
+    return hm_batch_run(&job, num_threads);
+}
+
+// As hungarian_method_batch(), but solving every problem on the calling thread
+// with the workspace ws, for callers that keep threads and workspaces of their
+// own, as hm_service.cc does. Returns false, solving nothing, if some n[k]
+// exceeds the capacity of ws.
+template <typename T>
+bool hungarian_method_batch(hm_workspace *ws, int count, int *const *mate,
+                            const T *const *c, const int *n)
+{
+    int k;
+    for (k = 0; k < count; ++k)
+    {
+        if (n[k] > hm_workspace_max_n(ws))
+        {
+            return false;
+        }
+    }
+
+    hm_batch_job<T> job;
+    job.count = count;
+    job.mate = mate;
+    job.c = c;
+    job.n = n;
+    for (k = 0; k < count; ++k)
+    {
+        hm_batch_solve_one(&job, ws, k);
+    }
+
+    return true;
+}
+
+// As hungarian_method_batch(), but with the problems packed contiguously: the
+// cost matrix of problem k follows that of problem k - 1 in c, and its 2 * n[k]
+// mate entries follow those of problem k - 1 in mate.
+template <typename T>
+bool hungarian_method_batch_packed(int count, int *mate, const T *c,
+                                   const int *n, int num_threads)
+{
+    int k;
+    size_t *offsets = (size_t *)malloc((2 * (size_t)count + 2) * sizeof(*offsets));
+    if (!offsets)
+    {
+        return false;
+    }
+
+    hm_batch_job<T> job;
+    job.count = count;
+    job.c = NULL;
+    job.n = n;
+    job.packed_mate = mate;
+    job.packed_c = c;
+    job.c_offset = offsets;
+    job.mate_offset = offsets + count + 1;
+    offsets[0] = offsets[count + 1] = 0;
+    for (k = 0; k < count; ++k)
+    {
+        offsets[k + 1] = offsets[k] + (size_t)n[k] * n[k];
+        offsets[count + k + 2] = offsets[count + k + 1] + 2 * (size_t)n[k];
+    }
+
+    bool ok = hm_batch_run(&job, num_threads);
+    free(offsets);
+    return ok;
+}
+
+// As hungarian_method_batch_packed(), but solving every problem on the calling
+// thread with the workspace ws, as the workspace overload of
+// hungarian_method_batch() does, for hm_capi.cc.
+template <typename T>
+bool hungarian_method_batch_packed(hm_workspace *ws, int count, int *mate,
+                                   const T *c, const int *n)
+{
+    int k;
+    for (k = 0; k < count; ++k)
+    {
+        if (n[k] > hm_workspace_max_n(ws))
+        {
+            return false;
+        }
+    }
+
+    for (k = 0; k < count; ++k)
+    {
+        hungarian_method(ws, mate, c, n[k]);
+        c += (size_t)n[k] * n[k];
+        mate += 2 * (size_t)n[k];
+    }
+
+    return true;
+}
+
+// The cost types for which the batched front end is compiled.
+template bool hungarian_method_batch(int, int *const *, const int32_t *const *,
+                                     const int *, int);
+template bool hungarian_method_batch(int, int *const *, const int64_t *const *,
+                                     const int *, int);
+template bool hungarian_method_batch(int, int *const *, const float *const *,
+                                     const int *, int);
+template bool hungarian_method_batch(int, int *const *, const double *const *,
+                                     const int *, int);
+template bool hungarian_method_batch(hm_workspace *, int, int *const *,
+                                     const int32_t *const *, const int *);
+template bool hungarian_method_batch(hm_workspace *, int, int *const *,
+                                     const int64_t *const *, const int *);
+template bool hungarian_method_batch(hm_workspace *, int, int *const *,
+                                     const float *const *, const int *);
+template bool hungarian_method_batch(hm_workspace *, int, int *const *,
+                                     const double *const *, const int *);
+template bool hungarian_method_batch_packed(int, int *, const int32_t *,
+                                            const int *, int);
+template bool hungarian_method_batch_packed(int, int *, const int64_t *,
+                                            const int *, int);
+template bool hungarian_method_batch_packed(int, int *, const float *,
+                                            const int *, int);
+template bool hungarian_method_batch_packed(int, int *, const double *,
+                                            const int *, int);
+template bool hungarian_method_batch_packed(hm_workspace *, int, int *,
+                                            const int32_t *, const int *);
+template bool hungarian_method_batch_packed(hm_workspace *, int, int *,
+                                            const int64_t *, const int *);
+template bool hungarian_method_batch_packed(hm_workspace *, int, int *,
+                                            const float *, const int *);
+template bool hungarian_method_batch_packed(hm_workspace *, int, int *,
+                                            const double *, const int *);
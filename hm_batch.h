@@ -0,0 +1,34 @@
+// Copyright 2010, 2017 William Rummler (w.a.rummler@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HM_BATCH_H
+#define HM_BATCH_H
+
+#include "hungarian_method.h"
+
+// Solves many independent assignment problems with hungarian_method(). See
+// hm_batch.cc. Compiled for the same cost types as hungarian_method().
+template <typename T>
+bool hungarian_method_batch(int, int *const *, const T *const *, const int *,
+                            int);
+template <typename T>
+bool hungarian_method_batch(hm_workspace *, int, int *const *,
+                            const T *const *, const int *);
+template <typename T>
+bool hungarian_method_batch_packed(int, int *, const T *, const int *, int);
+template <typename T>
+bool hungarian_method_batch_packed(hm_workspace *, int, int *, const T *,
+                                   const int *);
+
+#endif
@@ -0,0 +1,544 @@
+// Copyright 2010, 2017 William Rummler (w.a.rummler@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <http://www.gnu.org/licenses/>.
+
+// This file contains a benchmark of the solvers in this package, where
+// hm_test.cc checks their correctness. For each cost distribution and each n,
+// doubling from the least n to the greatest, every engine solves fresh random
+// problems until it has spent at least the given time solving, and a summary of
+// its solves is printed as one line of JSON. Every engine solves the same
+// problems, in the same order, so that their costs may be compared.
+//
+// An engine whose slowest solve at some n exceeds the budget is not run at any
+// greater n of that distribution, which bounds the time the O(n^3) engines take
+// on the largest problems.
+//
+// Usage:
+//
+//     hm_bench [--min-n N] [--max-n N] [--time S] [--budget S] [--seed X]
+//              [--engines hm,jv,auction,sparse]
+//              [--dists uniform,bounded,lowrank,geometric,adversarial]
+//              [--threads T] [--scan rows|columns]
+//              [--simd scalar|avx2|avx512|neon]
+//
+// --simd overrides the kernels selected for the running CPU (see hm_simd.h),
+// so that the kernels may be compared on the same machine.
+//
+// The first line printed describes the run. Each line after it describes one
+// engine at one n of one distribution, with the fields:
+//
+//     engine, dist, n  the point measured
+//     status           "ok", or "failed" if a solve reported failure
+//     solves, seconds  the number of solves, and the time they took in total
+//     solves_per_sec   their throughput
+//     p50_us, p90_us, p99_us, max_us
+//                      percentiles of their latencies, in microseconds
+//     cost             the cost of the first problem's solution
+//     peak_rss_kb      the peak resident memory of the process so far
+//     tail             for hm, when compiled with HM_STATS defined, the
+//                      statistics of its slowest solve (see hm_stats)
+
+#include "auction_assignment.h"
+#include "hm_simd.h"
+#include "hungarian_method.h"
+#include "jonker_volgenant.h"
+#include "sparse_assignment.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#define BENCH_MIN_N 8
+#define BENCH_MAX_N 10000
+#define BENCH_MIN_TIME 0.5
+#define BENCH_MIN_SOLVES 3
+#define BENCH_BUDGET 10.0
+#define BENCH_SEED 1
+
+// The cost distributions' parameters. MAX_COST is that of hm_test.cc.
+#define MAX_COST 100
+#define UNIFORM_MAX_COST (1 << 20)
+#define LOW_RANK 3
+#define LOW_RANK_MAX_FACTOR 100
+#define GEOMETRIC_SCALE 10000
+
+// The cost distributions.
+enum
+{
+    dist_uniform,     // uniform on [0, UNIFORM_MAX_COST)
+    dist_bounded,     // uniform on [1, MAX_COST], with many ties
+    dist_low_rank,    // the product of n*LOW_RANK and LOW_RANK*n factors
+    dist_geometric,   // distances between two sets of random points
+    dist_adversarial, // c[i][j] = i * j, after Machol and Wien
+    num_dists
+};
+
+static const char *dist_names[num_dists] =
+{
+    "uniform", "bounded", "lowrank", "geometric", "adversarial"
+};
+
+typedef struct bench_ bench;
+
+// This structure type holds one point of the benchmark, shared by its engines.
+struct bench_
+{
+    int n;
+    int *c;
+    int *mate;
+    hm_workspace *ws;
+    int *row_start; // the complete graph in CSR form, whose costs are c
+    int *col;
+    int num_threads;
+};
+
+static bool solve_hm(bench *b)
+{
+    return hungarian_method(b->ws, b->mate, b->c, b->n);
+}
+
+static bool solve_jv(bench *b)
+{
+    jonker_volgenant(b->mate, b->c, b->n);
+    return true;
+}
+
+static bool solve_auction(bench *b)
+{
+    return auction_assignment(b->mate, b->c, b->n, b->num_threads);
+}
+
+static bool solve_sparse(bench *b)
+{
+    return sparse_assignment(b->mate, b->row_start, b->col, b->c, b->n, b->n);
+}
+
+enum
+{
+    engine_hm,
+    engine_jv,
+    engine_auction,
+    engine_sparse,
+    num_engines
+};
+
+static const char *engine_names[num_engines] =
+{
+    "hm", "jv", "auction", "sparse"
+};
+
+static bool (*const engine_solve[num_engines])(bench *) =
+{
+    solve_hm, solve_jv, solve_auction, solve_sparse
+};
+
+// A splitmix64 generator, so that every engine sees the same problems on every
+// platform.
+static uint64_t next_random(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Returns a random int on [0, bound).
+static int random_below(uint64_t *state, int bound)
+{
+    return (int)(next_random(state) % (uint64_t)bound);
+}
+
+// Fills the n*n costs c with problem number k of the given distribution.
+static void fill_costs(int *c, int n, int dist, uint64_t seed, int k)
+{
+    int i, j, r;
+    uint64_t state = seed ^ ((uint64_t)dist << 56) ^ ((uint64_t)n << 24)
+        ^ (uint64_t)k;
+    std::vector<int> f;
+    switch (dist)
+    {
+    case dist_uniform:
+        for (i = 0; i < n * n; ++i)
+        {
+            c[i] = random_below(&state, UNIFORM_MAX_COST);
+        }
+
+        break;
+
+    case dist_bounded:
+        for (i = 0; i < n * n; ++i)
+        {
+            c[i] = random_below(&state, MAX_COST) + 1;
+        }
+
+        break;
+
+    case dist_low_rank:
+        f.resize(2 * n * LOW_RANK);
+        for (i = 0; i < 2 * n * LOW_RANK; ++i)
+        {
+            f[i] = random_below(&state, LOW_RANK_MAX_FACTOR);
+        }
+
+        for (i = 0; i < n; ++i)
+        {
+            for (j = 0; j < n; ++j)
+            {
+                c[i * n + j] = 0;
+                for (r = 0; r < LOW_RANK; ++r)
+                {
+                    c[i * n + j] += f[i * LOW_RANK + r]
+                        * f[(n + j) * LOW_RANK + r];
+                }
+            }
+        }
+
+        break;
+
+    case dist_geometric:
+        f.resize(4 * n);
+        for (i = 0; i < 4 * n; ++i)
+        {
+            f[i] = random_below(&state, GEOMETRIC_SCALE);
+        }
+
+        for (i = 0; i < n; ++i)
+        {
+            for (j = 0; j < n; ++j)
+            {
+                double dx = f[2 * i] - f[2 * (n + j)];
+                double dy = f[2 * i + 1] - f[2 * (n + j) + 1];
+                c[i * n + j] = (int)(sqrt(dx * dx + dy * dy) + 0.5);
+            }
+        }
+
+        break;
+
+    default:
+        for (i = 0; i < n; ++i)
+        {
+            for (j = 0; j < n; ++j)
+            {
+                c[i * n + j] = i * j;
+            }
+        }
+
+        break;
+    }
+}
+
+// Returns the peak resident memory of the process, in kilobytes.
+static long peak_rss_kb(void)
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+    {
+        return (long)(pmc.PeakWorkingSetSize / 1024);
+    }
+
+    return 0;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+// Returns the value at quantile q of the sorted latencies t, by nearest rank.
+static double percentile(const std::vector<double> &t, double q)
+{
+    size_t k = (size_t)ceil(q * t.size());
+    return t[k ? k - 1 : 0];
+}
+
+// Returns whether name appears in the comma-separated list.
+static bool in_list(const char *list, const char *name)
+{
+    size_t length = strlen(name);
+    const char *p = list;
+    while ((p = strstr(p, name)))
+    {
+        if ((p == list || p[-1] == ',') && (p[length] == ',' || !p[length]))
+        {
+            return true;
+        }
+
+        p += length;
+    }
+
+    return false;
+}
+
+// Measures one engine at one point, and prints its line. Returns the latency of
+// its slowest solve, in seconds.
+static double run_point(bench *b, int engine, int dist, uint64_t seed,
+                        double min_time)
+{
+    typedef std::chrono::steady_clock clock;
+    std::vector<double> t;
+    double total = 0;
+    int64_t cost = 0;
+    bool ok = true;
+    int i, k;
+    double slowest = -1;
+    const hm_stats *stats = engine == engine_hm ? hm_workspace_stats(b->ws)
+                                                : NULL;
+    hm_stats tail = hm_stats();
+
+    for (k = 0; ok && (total < min_time || k < BENCH_MIN_SOLVES); ++k)
+    {
+        fill_costs(b->c, b->n, dist, seed, k);
+        clock::time_point start = clock::now();
+        ok = engine_solve[engine](b);
+        double elapsed = std::chrono::duration<double>(clock::now() - start)
+            .count();
+        t.push_back(elapsed);
+        total += elapsed;
+        if (stats && elapsed > slowest)
+        {
+            slowest = elapsed;
+            tail = *stats;
+        }
+        if (ok && !k)
+        {
+            for (i = 0; i < b->n; ++i)
+            {
+                cost += b->c[i * b->n + b->mate[i] - b->n];
+            }
+        }
+    }
+
+    std::sort(t.begin(), t.end());
+    printf("{\"engine\":\"%s\",\"dist\":\"%s\",\"n\":%d,\"status\":\"%s\","
+           "\"solves\":%d,\"seconds\":%.6f,\"solves_per_sec\":%.3f,"
+           "\"p50_us\":%.1f,\"p90_us\":%.1f,\"p99_us\":%.1f,\"max_us\":%.1f,"
+           "\"cost\":%lld,\"peak_rss_kb\":%ld",
+           engine_names[engine], dist_names[dist], b->n, ok ? "ok" : "failed",
+           (int)t.size(), total, t.size() / total,
+           1e6 * percentile(t, 0.5), 1e6 * percentile(t, 0.9),
+           1e6 * percentile(t, 0.99), 1e6 * t.back(), (long long)cost,
+           peak_rss_kb());
+    if (stats)
+    {
+        printf(",\"tail\":{\"stages\":%lld,\"searches\":%lld,"
+               "\"modifies\":%lld,\"arcs\":%lld,\"path_edges\":%lld,"
+               "\"max_path_edges\":%lld,\"initialize_us\":%.1f,"
+               "\"construct_us\":%.1f,\"search_us\":%.1f,\"modify_us\":%.1f}",
+               (long long)tail.stages, (long long)tail.searches,
+               (long long)tail.modifies, (long long)tail.arcs,
+               (long long)tail.path_edges, (long long)tail.max_path_edges,
+               1e6 * tail.initialize_seconds, 1e6 * tail.construct_seconds,
+               1e6 * tail.search_seconds, 1e6 * tail.modify_seconds);
+    }
+
+    printf("}\n");
+    fflush(stdout);
+    return t.back();
+}
+
+// Allocates the arrays of b for the given n and the engines still running.
+// Returns false if memory is unavailable.
+static bool bench_alloc(bench *b, int n, const bool *running,
+                        const hm_options *options)
+{
+    int i, j;
+    size_t size = (size_t)n * n;
+    b->n = n;
+    b->c = (int *)malloc(size * sizeof(int));
+    b->mate = (int *)malloc(2 * (size_t)n * sizeof(int));
+    b->ws = running[engine_hm] ? hm_workspace_create(n, options) : NULL;
+    b->row_start = b->col = NULL;
+    if (running[engine_sparse])
+    {
+        b->row_start = (int *)malloc(((size_t)n + 1) * sizeof(int));
+        b->col = (int *)malloc(size * sizeof(int));
+        if (b->row_start && b->col)
+        {
+            for (i = 0; i <= n; ++i)
+            {
+                b->row_start[i] = i * n;
+            }
+
+            for (i = 0; i < n; ++i)
+            {
+                for (j = 0; j < n; ++j)
+                {
+                    b->col[i * n + j] = j;
+                }
+            }
+        }
+    }
+
+    return b->c && b->mate && (b->ws || !running[engine_hm])
+        && ((b->row_start && b->col) || !running[engine_sparse]);
+}
+
+static void bench_free(bench *b)
+{
+    free(b->c);
+    free(b->mate);
+    hm_workspace_free(b->ws);
+    free(b->row_start);
+    free(b->col);
+}
+
+// The benchmark entry point.
+int main(int argc, char **argv)
+{
+    int min_n = BENCH_MIN_N, max_n = BENCH_MAX_N, a, n, dist, engine;
+    double min_time = BENCH_MIN_TIME, budget = BENCH_BUDGET;
+    uint64_t seed = BENCH_SEED;
+    const char *engines = "hm,jv,auction,sparse";
+    const char *dists = "uniform,bounded,lowrank,geometric,adversarial";
+    hm_options options;
+    hm_options_init(&options);
+
+    for (a = 1; a + 1 < argc; a += 2)
+    {
+        if (!strcmp(argv[a], "--min-n"))
+        {
+            min_n = atoi(argv[a + 1]);
+        }
+        else if (!strcmp(argv[a], "--max-n"))
+        {
+            max_n = atoi(argv[a + 1]);
+        }
+        else if (!strcmp(argv[a], "--time"))
+        {
+            min_time = atof(argv[a + 1]);
+        }
+        else if (!strcmp(argv[a], "--budget"))
+        {
+            budget = atof(argv[a + 1]);
+        }
+        else if (!strcmp(argv[a], "--seed"))
+        {
+            seed = strtoull(argv[a + 1], NULL, 0);
+        }
+        else if (!strcmp(argv[a], "--engines"))
+        {
+            engines = argv[a + 1];
+        }
+        else if (!strcmp(argv[a], "--dists"))
+        {
+            dists = argv[a + 1];
+        }
+        else if (!strcmp(argv[a], "--threads"))
+        {
+            options.num_threads = atoi(argv[a + 1]);
+        }
+        else if (!strcmp(argv[a], "--simd"))
+        {
+            if (!hm_simd_select(argv[a + 1]))
+            {
+                fprintf(stderr, "%s: the %s kernels are unavailable\n",
+                        argv[0], argv[a + 1]);
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[a], "--scan"))
+        {
+            options.scan = strcmp(argv[a + 1], "columns") ? hm_scan_rows
+                                                          : hm_scan_columns;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if (a < argc || min_n < 1 || max_n < min_n)
+    {
+        fprintf(stderr, "usage: %s [--min-n N] [--max-n N] [--time S] "
+                "[--budget S] "
+                "[--seed X] [--engines LIST] [--dists LIST] [--threads T] "
+                "[--scan rows|columns] [--simd NAME]\n", argv[0]);
+        return 1;
+    }
+
+    printf("{\"bench\":\"hungarian_method\",\"simd\":\"%s\",\"threads\":%d,"
+           "\"scan\":\"%s\",\"seed\":%llu,\"min_time\":%.3f,\"budget\":%.3f}\n",
+           hm_simd()->name, options.num_threads,
+           options.scan == hm_scan_columns ? "columns" : "rows",
+           (unsigned long long)seed, min_time, budget);
+
+    for (dist = 0; dist < num_dists; ++dist)
+    {
+        if (!in_list(dists, dist_names[dist]))
+        {
+            continue;
+        }
+
+        bool running[num_engines];
+        int num_running = 0;
+        for (engine = 0; engine < num_engines; ++engine)
+        {
+            running[engine] = in_list(engines, engine_names[engine]);
+            num_running += running[engine];
+        }
+
+        // Double n up to max_n, which is measured even when not a power of two.
+        for (n = min_n; num_running > 0;
+             n = n < max_n && 2 * n > max_n ? max_n : 2 * n)
+        {
+            if (n > max_n)
+            {
+                break;
+            }
+
+            bench b;
+            b.num_threads = options.num_threads;
+            if (!bench_alloc(&b, n, running, &options))
+            {
+                fprintf(stderr, "%s: out of memory at n = %d\n", argv[0], n);
+                bench_free(&b);
+                break;
+            }
+
+            for (engine = 0; engine < num_engines; ++engine)
+            {
+                if (running[engine]
+                    && run_point(&b, engine, dist, seed, min_time) > budget)
+                {
+                    running[engine] = false;
+                    --num_running;
+                }
+            }
+
+            bench_free(&b);
+            if (n == max_n)
+            {
+                break;
+            }
+        }
+    }
+
+    return 0;
+}
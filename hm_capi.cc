@@ -0,0 +1,382 @@
+// Copyright 2010, 2017 William Rummler (w.a.rummler@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+// This file contains the plain C interface of hm_capi.h. A solver handle owns a
+// workspace, grown on demand, so that a caller binding the interface from
+// another language pays for allocation once rather than on every call, and
+// keeps the cost and duals of its last solve for querying afterwards.
+//
+// No C++ exception may cross the interface. Creating a workspace with threads
+// starts them through std::thread, and the standard library reports the
+// exhaustion of threads or memory by throwing, so every entry point that
+// reaches the solver catches everything and reports hm_capi_no_memory. The
+// queries only copy memory, and throw nothing.
+
+#include "hm_capi.h"
+#include "hm_batch.h"
+#include "hungarian_method.h"
+#include <cstdlib>
+#include <cstring>
+
+struct hm_solver_
+{
+    hm_workspace *ws;
+    hm_options options;
+    int max_n;      // the capacity of ws
+    void *duals;    // alpha then beta of the last solve, as max_n values each
+
+    // The last solve, for the queries: its cost type, or zero if there is
+    // none, its n, and its cost, if that fits its cost type.
+    int dtype;
+    int n;
+    bool cost_fits;
+    unsigned char cost[8];
+};
+
+// Returns the size in bytes of a cost of the given type, or zero if the type is
+// unknown.
+static size_t hm_capi_size(int dtype)
+{
+    switch (dtype)
+    {
+    case hm_capi_int32: return sizeof(int32_t);
+    case hm_capi_int64: return sizeof(int64_t);
+    case hm_capi_float32: return sizeof(float);
+    case hm_capi_float64: return sizeof(double);
+    default: return 0;
+    }
+}
+
+// Grows the workspace and buffers of s to hold problems of n vertices a side.
+// Returns false, leaving s as it was, if memory is unavailable.
+static bool hm_solver_reserve(hm_solver *s, int n)
+{
+    if (n <= s->max_n)
+    {
+        return true;
+    }
+
+    hm_workspace *ws = hm_workspace_create(n, &s->options);
+    void *duals = malloc(2 * (size_t)n * sizeof(double) + 1);
+    if (!ws || !duals)
+    {
+        hm_workspace_free(ws);
+        free(duals);
+        return false;
+    }
+
+    hm_workspace_free(s->ws);
+    free(s->duals);
+    s->ws = ws;
+    s->duals = duals;
+    s->max_n = n;
+    s->dtype = 0;
+    return true;
+}
+
+// Solves the n*n costs c with s, fills mate, and keeps the cost and duals.
+template <typename T>
+static void hm_solver_solve_as(hm_solver *s, const T *c, int n, int sense,
+                               int *mate)
+{
+    hm_solution<T> solution;
+    solution.alpha = (T *)s->duals;
+    solution.beta = solution.alpha + n;
+    hungarian_method(s->ws, mate, c, n, sense, &solution);
+    memcpy(s->cost, &solution.cost, sizeof(solution.cost));
+    s->cost_fits = solution.cost_fits;
+}
+
+// Returns HM_CAPI_VERSION, the version of the interface this library provides.
+int hm_capi_version(void)
+{
+    return HM_CAPI_VERSION;
+}
+
+// Returns a short description of the given status code.
+const char *hm_capi_status_string(int status)
+{
+    switch (status)
+    {
+    case hm_capi_ok: return "ok";
+    case hm_capi_invalid_argument: return "invalid argument";
+    case hm_capi_no_memory: return "out of memory";
+    case hm_capi_no_solution: return "no solution";
+    case hm_capi_version_mismatch: return "version mismatch";
+    case hm_capi_out_of_range: return "out of range";
+    default: return "unknown status";
+    }
+}
+
+// Input:
+//
+// version is HM_CAPI_VERSION as the caller was compiled against it.
+//
+// max_n is the largest n expected, for which memory is reserved at once. Larger
+// problems are still solved, growing the solver as needed.
+//
+// num_threads is the number of threads to solve with, for problems large
+// enough to be solved in parallel, alone or in a batch. The solver starts them
+// here and keeps them until destroyed. Zero or less selects one per hardware
+// thread, and one solves serially.
+//
+// Output:
+//
+// Sets *solver to a new solver and returns hm_capi_ok, or returns an error,
+// leaving *solver NULL if solver is not itself NULL.
+int hm_solver_create(int version, int max_n, int num_threads,
+                     hm_solver **solver)
+{
+    if (!solver)
+    {
+        return hm_capi_invalid_argument;
+    }
+
+    *solver = NULL;
+    if (version != HM_CAPI_VERSION)
+    {
+        return hm_capi_version_mismatch;
+    }
+
+    if (max_n < 0)
+    {
+        return hm_capi_invalid_argument;
+    }
+
+    hm_solver *s = (hm_solver *)calloc(1, sizeof(*s));
+    if (!s)
+    {
+        return hm_capi_no_memory;
+    }
+
+    hm_options_init(&s->options);
+    s->options.num_threads = num_threads;
+    s->max_n = -1;
+    bool ok;
+    try
+    {
+        ok = hm_solver_reserve(s, max_n);
+    }
+    catch (...)
+    {
+        ok = false;
+    }
+
+    if (!ok)
+    {
+        free(s);
+        return hm_capi_no_memory;
+    }
+
+    *solver = s;
+    return hm_capi_ok;
+}
+
+// Releases a solver obtained from hm_solver_create(). Passing NULL is allowed
+// and does nothing.
+void hm_solver_destroy(hm_solver *s)
+{
+    if (s)
+    {
+        try
+        {
+            hm_workspace_free(s->ws);
+        }
+        catch (...)
+        {
+        }
+
+        free(s->duals);
+        free(s);
+    }
+}
+
+// Input:
+//
+// dtype is the cost type of c, one of hm_capi_int32, ..., hm_capi_float64.
+//
+// c, n, and mate are as described for hungarian_method(): c holds n*n costs in
+// row-major order, and mate receives the 2 * n entries of the matching.
+//
+// sense is hm_capi_minimize or hm_capi_maximize.
+//
+// Output:
+//
+// Fills mate and returns hm_capi_ok, after which hm_solver_cost() and
+// hm_solver_duals() report on this solve. Otherwise returns an error, leaving
+// mate untouched.
+int hm_solver_solve(hm_solver *s, int dtype, const void *c, int n, int sense,
+                    int *mate)
+{
+    if (!s || !c || !mate || n < 0 || !hm_capi_size(dtype)
+        || (sense != hm_capi_minimize && sense != hm_capi_maximize))
+    {
+        return hm_capi_invalid_argument;
+    }
+
+    try
+    {
+        if (!hm_solver_reserve(s, n))
+        {
+            return hm_capi_no_memory;
+        }
+
+        switch (dtype)
+        {
+        case hm_capi_int32:
+            hm_solver_solve_as(s, (const int32_t *)c, n, sense, mate);
+            break;
+        case hm_capi_int64:
+            hm_solver_solve_as(s, (const int64_t *)c, n, sense, mate);
+            break;
+        case hm_capi_float32:
+            hm_solver_solve_as(s, (const float *)c, n, sense, mate);
+            break;
+        default:
+            hm_solver_solve_as(s, (const double *)c, n, sense, mate);
+            break;
+        }
+    }
+    catch (...)
+    {
+        s->dtype = 0;
+        return hm_capi_no_memory;
+    }
+
+    s->dtype = dtype;
+    s->n = n;
+    return hm_capi_ok;
+}
+
+// Solves count problems of the given cost type at once, packed as for
+// hungarian_method_batch_packed(): the costs of each problem, and its 2 * n[k]
+// mate entries, follow those of the one before. The problems are solved in turn
+// with the solver's workspace, grown first to the largest of them, and those
+// large enough are split across the solver's threads, so that a batch, like a
+// single solve, starts no threads and allocates nothing once the solver has
+// grown. The batch is minimized, and leaves nothing to query. Returns
+// hm_capi_ok, or an error, in which case any of the mates may have been filled.
+int hm_solver_solve_batch(hm_solver *s, int dtype, int count, const void *c,
+                          const int *n, int *mate)
+{
+    int k, max_n = 0;
+    if (!s || count < 0 || (count > 0 && (!c || !n || !mate))
+        || !hm_capi_size(dtype))
+    {
+        return hm_capi_invalid_argument;
+    }
+
+    for (k = 0; k < count; ++k)
+    {
+        if (n[k] < 0)
+        {
+            return hm_capi_invalid_argument;
+        }
+
+        if (n[k] > max_n)
+        {
+            max_n = n[k];
+        }
+    }
+
+    bool ok;
+    s->dtype = 0;
+    try
+    {
+        if (!hm_solver_reserve(s, max_n))
+        {
+            return hm_capi_no_memory;
+        }
+
+        switch (dtype)
+        {
+        case hm_capi_int32:
+            ok = hungarian_method_batch_packed(s->ws, count, mate,
+                                               (const int32_t *)c, n);
+            break;
+        case hm_capi_int64:
+            ok = hungarian_method_batch_packed(s->ws, count, mate,
+                                               (const int64_t *)c, n);
+            break;
+        case hm_capi_float32:
+            ok = hungarian_method_batch_packed(s->ws, count, mate,
+                                               (const float *)c, n);
+            break;
+        default:
+            ok = hungarian_method_batch_packed(s->ws, count, mate,
+                                               (const double *)c, n);
+            break;
+        }
+    }
+    catch (...)
+    {
+        ok = false;
+    }
+
+    return ok ? hm_capi_ok : hm_capi_no_memory;
+}
+
+// Copies the cost of the last solve to cost, as one value of its cost type.
+// Returns hm_capi_no_solution if there has been no solve since the last batch
+// or growth of the solver, and hm_capi_out_of_range, leaving cost untouched, if
+// the cost lies outside the range of its type, as the sum of several int32
+// costs may.
+int hm_solver_cost(const hm_solver *s, void *cost)
+{
+    if (!s || !cost)
+    {
+        return hm_capi_invalid_argument;
+    }
+
+    if (!s->dtype)
+    {
+        return hm_capi_no_solution;
+    }
+
+    if (!s->cost_fits)
+    {
+        return hm_capi_out_of_range;
+    }
+
+    memcpy(cost, s->cost, hm_capi_size(s->dtype));
+    return hm_capi_ok;
+}
+
+// Copies the optimal duals of the last solve to alpha and beta, as n values of
+// its cost type each, as hungarian_method() reports them in a solution: when
+// minimizing, alpha[i] + beta[j] <= c[i][j] for all i and j, and when
+// maximizing, alpha[i] + beta[j] >= c[i][j], with equality on each edge of the
+// matching. Returns hm_capi_no_solution as hm_solver_cost() does.
+int hm_solver_duals(const hm_solver *s, void *alpha, void *beta)
+{
+    if (!s || (s->n > 0 && (!alpha || !beta)))
+    {
+        return hm_capi_invalid_argument;
+    }
+
+    if (!s->dtype)
+    {
+        return hm_capi_no_solution;
+    }
+
+    size_t size = (size_t)s->n * hm_capi_size(s->dtype);
+    if (size)
+    {
+        memcpy(alpha, s->duals, size);
+        memcpy(beta, (const unsigned char *)s->duals + size, size);
+    }
+
+    return hm_capi_ok;
+}
@@ -0,0 +1,79 @@
+// Copyright 2010, 2017 William Rummler (w.a.rummler@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HM_CAPI_H
+#define HM_CAPI_H
+
+// A plain C interface to the solver, for embedding and for binding from other
+// languages through a foreign function interface. Only C types cross it: the
+// solver is an opaque handle, costs are passed as untyped pointers tagged with
+// a cost type, and every function that can fail returns a status code. See
+// hm_capi.cc.
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The version of this interface. It is raised whenever the interface changes
+// incompatibly, and callers pass the version they were compiled against to
+// hm_solver_create(), which refuses to create a solver for any other.
+#define HM_CAPI_VERSION 1
+
+// The status codes.
+enum
+{
+    hm_capi_ok = 0,
+    hm_capi_invalid_argument = 1, // a NULL pointer, or a value out of range
+    hm_capi_no_memory = 2,        // memory or threads were unavailable
+    hm_capi_no_solution = 3,      // no solve yet to query
+    hm_capi_version_mismatch = 4, // the caller's version is not this one
+    hm_capi_out_of_range = 5      // the cost does not fit its type
+};
+
+// The cost types, with the values of the hm_dtype_* of hm_cost_file.h.
+enum
+{
+    hm_capi_int32 = 1,
+    hm_capi_int64 = 2,
+    hm_capi_float32 = 3,
+    hm_capi_float64 = 4
+};
+
+// The objective senses, with the values of hm_minimize and hm_maximize.
+enum
+{
+    hm_capi_minimize = 0,
+    hm_capi_maximize = 1
+};
+
+typedef struct hm_solver_ hm_solver;
+
+int hm_capi_version(void);
+const char *hm_capi_status_string(int);
+
+int hm_solver_create(int, int, int, hm_solver **);
+void hm_solver_destroy(hm_solver *);
+int hm_solver_solve(hm_solver *, int, const void *, int, int, int *);
+int hm_solver_solve_batch(hm_solver *, int, int, const void *, const int *,
+                          int *);
+int hm_solver_cost(const hm_solver *, void *);
+int hm_solver_duals(const hm_solver *, void *, void *);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,315 @@
+// Copyright 2010, 2017 William Rummler (w.a.rummler@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <http://www.gnu.org/licenses/>.
+
+// This file contains a loader for cost matrices stored on disk, which maps a
+// file into memory so that its costs are passed to the solver in place, with no
+// copy. Since the solver only ever reads its costs, and the mapping is shared
+// and read-only, any number of threads or processes may solve against one file
+// at once, all reading the same page-cached copy of it.
+//
+// A file consists of a 64-byte header followed by the n*n costs in row-major
+// order, so that the costs begin suitably aligned for the vectorized kernels.
+// The header's fields are little-endian:
+//
+//     offset  size  field
+//          0     8  magic, the bytes "HMCOST\0\0"
+//          8     4  version, currently 1
+//         12     4  dtype, one of hm_dtype_int32, ..., hm_dtype_float64
+//         16     4  layout, currently always hm_layout_row_major
+//         20     4  reserved, zero
+//         24     8  n
+//         32    32  reserved, zero
+//
+// The costs themselves are stored in the host's native representation, which
+// must be little-endian as well. The layout field reserves room for other
+// layouts, e.g. tiled ones, which are rejected until supported.
+//
+// The solver reads the costs a row at a time, first all of them in order for
+// the initial column minima, and then the rows of the vertices it labels, in
+// no predictable order and repeatedly. The mapping is therefore advised as
+// needed in full, starting readahead of the whole file at once, rather than as
+// sequential, which would let the kernel drop pages soon after their first use.
+
+#include "hm_cost_file.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define HM_COST_FILE_VERSION 1
+
+enum
+{
+    hm_cost_file_header_size = 64
+};
+
+static const char hm_cost_file_magic[8] = { 'H', 'M', 'C', 'O', 'S', 'T', 0, 0 };
+
+struct hm_cost_file_
+{
+    void *map;   // the mapping of the whole file
+    size_t size; // the size of the mapping, in bytes
+    int n;
+    int dtype;
+#ifdef _WIN32
+    HANDLE mapping;
+#endif
+};
+
+// Returns the size in bytes of a cost of the given type, or zero if the type is
+// unknown.
+static size_t hm_dtype_size(int dtype)
+{
+    switch (dtype)
+    {
+    case hm_dtype_int32: return 4;
+    case hm_dtype_int64: return 8;
+    case hm_dtype_float32: return 4;
+    case hm_dtype_float64: return 8;
+    default: return 0;
+    }
+}
+
+static uint32_t hm_get32(const unsigned char *p)
+{
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16
+        | (uint32_t)p[3] << 24;
+}
+
+static uint64_t hm_get64(const unsigned char *p)
+{
+    return (uint64_t)hm_get32(p) | (uint64_t)hm_get32(p + 4) << 32;
+}
+
+static void hm_put32(unsigned char *p, uint32_t x)
+{
+    p[0] = (unsigned char)x;
+    p[1] = (unsigned char)(x >> 8);
+    p[2] = (unsigned char)(x >> 16);
+    p[3] = (unsigned char)(x >> 24);
+}
+
+static void hm_put64(unsigned char *p, uint64_t x)
+{
+    hm_put32(p, (uint32_t)x);
+    hm_put32(p + 4, (uint32_t)(x >> 32));
+}
+
+static bool hm_little_endian(void)
+{
+    const uint32_t one = 1;
+    return *(const unsigned char *)&one == 1;
+}
+
+// Validates the header at the start of the mapping of f, and sets f's n and
+// dtype from it. Returns false if the header is malformed or the mapping is too
+// short for the costs it announces.
+static bool hm_cost_file_parse(hm_cost_file *f)
+{
+    const unsigned char *h = (const unsigned char *)f->map;
+    if (f->size < hm_cost_file_header_size
+        || memcmp(h, hm_cost_file_magic, sizeof(hm_cost_file_magic))
+        || hm_get32(h + 8) != HM_COST_FILE_VERSION
+        || hm_get32(h + 16) != hm_layout_row_major)
+    {
+        return false;
+    }
+
+    uint32_t dtype = hm_get32(h + 12);
+    uint64_t n = hm_get64(h + 24);
+    size_t size = hm_dtype_size((int)dtype);
+    if (!size || n > INT_MAX
+        || n * n > (f->size - hm_cost_file_header_size) / size)
+    {
+        return false;
+    }
+
+    f->n = (int)n;
+    f->dtype = (int)dtype;
+    return true;
+}
+
+// Maps the cost file at path. Returns NULL if the file cannot be mapped or is
+// not a cost file this loader supports.
+hm_cost_file *hm_cost_file_open(const char *path)
+{
+    hm_cost_file *f;
+    if (!hm_little_endian() || !(f = (hm_cost_file *)malloc(sizeof(*f))))
+    {
+        return NULL;
+    }
+
+#ifdef _WIN32
+    LARGE_INTEGER size;
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        free(f);
+        return NULL;
+    }
+
+    // The mapping holds its own reference to the file.
+    f->mapping = NULL;
+    f->map = NULL;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0
+        && (uint64_t)size.QuadPart <= (size_t)-1)
+    {
+        f->size = (size_t)size.QuadPart;
+        f->mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (f->mapping)
+        {
+            f->map = MapViewOfFile(f->mapping, FILE_MAP_READ, 0, 0, 0);
+        }
+    }
+
+    CloseHandle(file);
+    if (!f->map)
+    {
+        if (f->mapping)
+        {
+            CloseHandle(f->mapping);
+        }
+
+        free(f);
+        return NULL;
+    }
+#else
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        free(f);
+        return NULL;
+    }
+
+    // The mapping holds its own reference to the file.
+    f->map = MAP_FAILED;
+    if (!fstat(fd, &st) && st.st_size > 0
+        && (uint64_t)st.st_size <= (size_t)-1)
+    {
+        f->size = (size_t)st.st_size;
+        f->map = mmap(NULL, f->size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+
+    close(fd);
+    if (f->map == MAP_FAILED)
+    {
+        free(f);
+        return NULL;
+    }
+#endif
+
+    if (!hm_cost_file_parse(f))
+    {
+        hm_cost_file_close(f);
+        return NULL;
+    }
+
+#ifndef _WIN32
+    // A failed hint is harmless, so its result is ignored.
+    madvise(f->map, f->size, MADV_WILLNEED);
+#endif
+    return f;
+}
+
+void hm_cost_file_close(hm_cost_file *f)
+{
+    if (f)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(f->map);
+        CloseHandle(f->mapping);
+#else
+        munmap(f->map, f->size);
+#endif
+        free(f);
+    }
+}
+
+int hm_cost_file_n(const hm_cost_file *f)
+{
+    return f->n;
+}
+
+int hm_cost_file_dtype(const hm_cost_file *f)
+{
+    return f->dtype;
+}
+
+// Returns the file's n*n costs, of the type given by hm_cost_file_dtype(), for
+// passing to the solver as c. The costs remain valid until the file is closed.
+const void *hm_cost_file_data(const hm_cost_file *f)
+{
+    return (const unsigned char *)f->map + hm_cost_file_header_size;
+}
+
+// Writes the n*n row-major costs c, of the given type, to a new cost file at
+// path. Returns false if the type is unknown or the file cannot be written.
+bool hm_cost_file_write(const char *path, int dtype, const void *c, int n)
+{
+    unsigned char h[hm_cost_file_header_size];
+    size_t size = hm_dtype_size(dtype);
+    if (!size || n < 0 || !hm_little_endian())
+    {
+        return false;
+    }
+
+    memset(h, 0, sizeof(h));
+    memcpy(h, hm_cost_file_magic, sizeof(hm_cost_file_magic));
+    hm_put32(h + 8, HM_COST_FILE_VERSION);
+    hm_put32(h + 12, (uint32_t)dtype);
+    hm_put32(h + 16, hm_layout_row_major);
+    hm_put64(h + 24, (uint64_t)n);
+
+    FILE *fp = fopen(path, "wb");
+    if (!fp)
+    {
+        return false;
+    }
+
+    size_t count = (size_t)n * n;
+    bool ok = fwrite(h, 1, sizeof(h), fp) == sizeof(h)
+        && fwrite(c, size, count, fp) == count;
+    return fclose(fp) == 0 && ok;
+}
+
+// Solves the problem in the file f with the workspace ws, passing the mapped
+// costs to the instantiation of hungarian_method() for the file's cost type.
+// Fills mate, and returns, as that function does.
+bool hm_cost_file_solve(hm_workspace *ws, int *mate, const hm_cost_file *f)
+{
+    const void *c = hm_cost_file_data(f);
+    switch (f->dtype)
+    {
+    case hm_dtype_int32:
+        return hungarian_method(ws, mate, (const int32_t *)c, f->n);
+    case hm_dtype_int64:
+        return hungarian_method(ws, mate, (const int64_t *)c, f->n);
+    case hm_dtype_float32:
+        return hungarian_method(ws, mate, (const float *)c, f->n);
+    default:
+        return hungarian_method(ws, mate, (const double *)c, f->n);
+    }
+}
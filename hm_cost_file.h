@@ -0,0 +1,47 @@
+// Copyright 2010, 2017 William Rummler (w.a.rummler@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HM_COST_FILE_H
+#define HM_COST_FILE_H
+
+#include "hungarian_method.h"
+
+// A cost matrix file mapped read-only into memory. See hm_cost_file.cc for the
+// on-disk format.
+typedef struct hm_cost_file_ hm_cost_file;
+
+// The cost types a file may hold.
+enum
+{
+    hm_dtype_int32 = 1,
+    hm_dtype_int64 = 2,
+    hm_dtype_float32 = 3,
+    hm_dtype_float64 = 4
+};
+
+// The cost layouts a file may hold.
+enum
+{
+    hm_layout_row_major = 1
+};
+
+hm_cost_file *hm_cost_file_open(const char *);
+void hm_cost_file_close(hm_cost_file *);
+int hm_cost_file_n(const hm_cost_file *);
+int hm_cost_file_dtype(const hm_cost_file *);
+const void *hm_cost_file_data(const hm_cost_file *);
+bool hm_cost_file_write(const char *, int, const void *, int);
+bool hm_cost_file_solve(hm_workspace *, int *, const hm_cost_file *);
+
+#endif
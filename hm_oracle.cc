@@ -0,0 +1,136 @@
+// Copyright 2010, 2017 William Rummler (w.a.rummler@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <http://www.gnu.org/licenses/>.
+
+// This file contains the row cache of hm_oracle_solve(), which solves problems
+// whose costs are computed on demand by a caller-supplied function, e.g. from
+// the coordinates of two point sets whose n*n distance matrix would not fit in
+// memory. The solver itself is that of jonker_volgenant_core.h, which
+// hm_oracle.h instantiates for the caller's function.
+//
+// The shortest path trees of successive augmentations tend to scan the same
+// rows, namely those assigned to the columns nearest each free row, so keeping
+// the most recently scanned rows avoids most recomputation for a fraction of
+// the matrix's memory. The cache maps rows to slots through an array indexed by
+// row, and orders the slots by recency in a doubly linked list, so that a hit,
+// a miss, and an eviction each take O(1) time.
+
+#include "hm_oracle.h"
+
+struct hm_row_cache_
+{
+    int n;     // the length of each row
+    int size;  // the number of slots
+    int head;  // the most recently used slot
+    int tail;  // the least recently used slot, evicted on a miss
+    int *slot; // the slot holding each row, or -1 for rows not held
+    int *row;  // the row held in each slot, or -1 for empty slots
+    int *prev; // the next more recently used slot, or -1 for the head
+    int *next; // the next less recently used slot, or -1 for the tail
+    int *data; // the rows, size * n ints
+};
+
+// Returns a cache of size rows of n ints, where 0 < size <= n, or NULL if
+// memory is unavailable.
+hm_row_cache *hm_row_cache_create(int n, int size)
+{
+    hm_row_cache *cache = (hm_row_cache *)malloc(sizeof(*cache));
+    if (!cache)
+    {
+        return NULL;
+    }
+
+    int *p = (int *)malloc(((size_t)n + 3 * (size_t)size
+                            + (size_t)size * n) * sizeof(*p));
+    if (!p)
+    {
+        free(cache);
+        return NULL;
+    }
+
+    cache->n = n;
+    cache->size = size;
+    cache->slot = p;
+    cache->row = (p += n);
+    cache->prev = (p += size);
+    cache->next = (p += size);
+    cache->data = p + size;
+
+    // Start with the slots linked in order, all of them empty.
+    int k;
+    for (k = 0; k < n; ++k)
+    {
+        cache->slot[k] = -1;
+    }
+
+    for (k = 0; k < size; ++k)
+    {
+        cache->row[k] = -1;
+        cache->prev[k] = k - 1;
+        cache->next[k] = k + 1 < size ? k + 1 : -1;
+    }
+
+    cache->head = 0;
+    cache->tail = size - 1;
+    return cache;
+}
+
+void hm_row_cache_free(hm_row_cache *cache)
+{
+    if (cache)
+    {
+        free(cache->slot);
+        free(cache);
+    }
+}
+
+// Returns the n ints of the slot for row i, marking it most recently used, and
+// sets *hit to whether the slot already holds the row. Otherwise the least
+// recently used row is evicted, and the caller must fill the slot.
+int *hm_row_cache_get(hm_row_cache *cache, int i, bool *hit)
+{
+    int k = cache->slot[i];
+    *hit = k >= 0;
+    if (!*hit)
+    {
+        k = cache->tail;
+        if (cache->row[k] >= 0)
+        {
+            cache->slot[cache->row[k]] = -1;
+        }
+
+        cache->row[k] = i;
+        cache->slot[i] = k;
+    }
+
+    // Move slot k to the head of the list.
+    if (k != cache->head)
+    {
+        cache->next[cache->prev[k]] = cache->next[k];
+        if (cache->next[k] >= 0)
+        {
+            cache->prev[cache->next[k]] = cache->prev[k];
+        }
+        else
+        {
+            cache->tail = cache->prev[k];
+        }
+
+        cache->prev[k] = -1;
+        cache->next[k] = cache->head;
+        cache->prev[cache->head] = k;
+        cache->head = k;
+    }
+
+    return cache->data + (size_t)k * cache->n;
+}
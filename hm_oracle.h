@@ -0,0 +1,147 @@
+// Copyright 2010, 2017 William Rummler (w.a.rummler@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HM_ORACLE_H
+#define HM_ORACLE_H
+
+#include "jonker_volgenant_core.h"
+#include <cstdlib>
+
+// A least-recently-used cache of cost rows, each of n ints. See hm_oracle.cc.
+typedef struct hm_row_cache_ hm_row_cache;
+
+hm_row_cache *hm_row_cache_create(int, int);
+void hm_row_cache_free(hm_row_cache *);
+int *hm_row_cache_get(hm_row_cache *, int, bool *);
+
+// The solver is that of jonker_volgenant_core.h, with costs read through the
+// accessors below, which are defined here rather than in hm_oracle.cc so that
+// the cost functor is inlined into the solver's loops.
+
+// Costs computed on every read. A row is merely its index, so that only the
+// costs the solver reads, those of the columns still unscanned, are computed.
+template <typename F>
+struct hm_oracle_direct
+{
+    struct row_type
+    {
+        F *cost;
+        int i;
+
+        int operator[](int j) const
+        {
+            return (*cost)(i, j);
+        }
+    };
+
+    F *cost;
+
+    row_type row(int i) const
+    {
+        row_type r = { cost, i };
+        return r;
+    }
+};
+
+// Costs computed a whole row at a time, into the row cache.
+template <typename F>
+struct hm_oracle_cached
+{
+    typedef const int *row_type;
+
+    F *cost;
+    hm_row_cache *cache;
+    int n;
+
+    // Returns row i of the costs from the cache, computing it on a miss.
+    row_type row(int i) const
+    {
+        bool hit;
+        int j, *r = hm_row_cache_get(cache, i, &hit);
+        if (!hit)
+        {
+            for (j = 0; j < n; ++j)
+            {
+                r[j] = (*cost)(i, j);
+            }
+        }
+
+        return r;
+    }
+};
+
+// Input:
+//
+// mate points to a memory block of at least 2n ints. It is used to represent
+// and return the solution matching.
+//
+// cost is a function or functor such that cost(i, j) returns, as an int, the
+// cost of the edge from vertex i of V to vertex n + j of U, for i and j in
+// {0,...,n-1}. It is called as the solver needs each cost, so the n*n cost
+// matrix is never materialized, and must return the same value for the same
+// edge every time.
+//
+// cache_rows is the number of rows of n costs to keep, least recently used
+// first out, so that rows scanned repeatedly are not recomputed. At zero, each
+// cost is recomputed whenever it is read.
+//
+// Output:
+//
+// Fills mate exactly as hungarian_method() does. Returns false, with mate
+// untouched, if memory is unavailable.
+//
+// The solve is that of jonker_volgenant(), which, unlike hungarian_method(),
+// needs only O(n) memory besides the cache. Every cost is computed once for the
+// column reduction and then once per row scanned by each augmentation.
+template <typename F>
+bool hm_oracle_solve(int *mate, F cost, int n, int cache_rows = 0)
+{
+    int *p = (int *)malloc(jv_size(n, n) * sizeof(*p));
+    if (!p)
+    {
+        return false;
+    }
+
+    bool ok = true;
+    if (cache_rows > 0 && n > 0)
+    {
+        jv_data<hm_oracle_cached<F> > jv;
+        jv.costs.cost = &cost;
+        jv.costs.n = n;
+        jv.costs.cache = hm_row_cache_create(n, cache_rows < n ? cache_rows : n);
+        if ((ok = jv.costs.cache != NULL))
+        {
+            jv.mate = mate;
+            jv.n = jv.m = n;
+            jv_bind(&jv, p);
+            jv_solve(&jv);
+        }
+
+        hm_row_cache_free(jv.costs.cache);
+    }
+    else
+    {
+        jv_data<hm_oracle_direct<F> > jv;
+        jv.costs.cost = &cost;
+        jv.mate = mate;
+        jv.n = jv.m = n;
+        jv_bind(&jv, p);
+        jv_solve(&jv);
+    }
+
+    free(p);
+    return ok;
+}
+
+#endif
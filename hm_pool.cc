@@ -0,0 +1,205 @@
+// Copyright 2010, 2017 William Rummler (w.a.rummler@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <http://www.gnu.org/licenses/>.
+
+// This file contains the thread pool behind the intra-solve parallel mode of
+// hungarian_method.cc. A solve of size n runs O(n^2) parallel phases, each only
+// O(n) long, so the cost of starting one must be small next to that of a few
+// thousand loop iterations. The members therefore spin for a while before
+// sleeping, and the caller spins while it waits for them to finish, so that a
+// phase costs one pass over two atomic words when the team is busy. Between
+// solves, members fall asleep on a condition variable and cost nothing.
+
+#include "hm_pool.h"
+#include <cstdlib>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+// The number of times a member polls for the next phase before sleeping.
+#define HM_POOL_SPIN 4096
+
+struct hm_pool_
+{
+    int num_threads;
+    std::vector<std::thread> threads;
+    void *slots;
+
+    // The current phase, published by bumping generation.
+    void (*fn)(void *, int);
+    void *ctx;
+    bool stop;
+    std::atomic<unsigned> generation;
+    std::atomic<int> remaining;
+
+    // For members that have stopped spinning, num_sleeping counting them.
+    std::atomic<int> num_sleeping;
+    std::mutex lock;
+    std::condition_variable wake;
+};
+
+// The body of member w > 0: wait for each phase, run it, and report back.
+static void hm_pool_member(hm_pool *pool, int w)
+{
+    int spin;
+    unsigned seen = 0;
+    for (;;)
+    {
+        for (spin = 0; spin < HM_POOL_SPIN; ++spin)
+        {
+            if (pool->generation.load(std::memory_order_acquire) != seen)
+            {
+                break;
+            }
+
+            std::this_thread::yield();
+        }
+
+        if (spin == HM_POOL_SPIN)
+        {
+            std::unique_lock<std::mutex> guard(pool->lock);
+            pool->num_sleeping.fetch_add(1);
+            while (pool->generation.load() == seen)
+            {
+                pool->wake.wait(guard);
+            }
+
+            pool->num_sleeping.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        seen = pool->generation.load(std::memory_order_acquire);
+        if (pool->stop)
+        {
+            return;
+        }
+
+        pool->fn(pool->ctx, w);
+        pool->remaining.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+// Publishes a new phase to every member. While all of them are spinning, this
+// is a single atomic increment. Otherwise the lock is taken before notifying: a
+// member increments num_sleeping under it before rechecking generation, each
+// access sequentially consistent, so either that member sees the new phase or
+// this sees it counted, and it is then already waiting when notified.
+static void hm_pool_publish(hm_pool *pool)
+{
+    pool->generation.fetch_add(1);
+    if (pool->num_sleeping.load() != 0)
+    {
+        {
+            std::lock_guard<std::mutex> guard(pool->lock);
+        }
+
+        pool->wake.notify_all();
+    }
+}
+
+// Stops the members of pool and waits for them to exit.
+static void hm_pool_stop(hm_pool *pool)
+{
+    pool->stop = true;
+    hm_pool_publish(pool);
+    for (size_t w = 0; w < pool->threads.size(); ++w)
+    {
+        pool->threads[w].join();
+    }
+}
+
+// Creates a pool of num_threads members, the caller of hm_pool_run() being
+// member zero. Returns NULL if num_threads is less than one or memory is
+// unavailable, or if a member thread cannot be started, in which case those
+// already started are stopped.
+hm_pool *hm_pool_create(int num_threads)
+{
+    hm_pool *pool;
+    if (num_threads < 1 || !(pool = new (std::nothrow) hm_pool_))
+    {
+        return NULL;
+    }
+
+    if (!(pool->slots = malloc((size_t)num_threads * hm_pool_slot_size)))
+    {
+        delete pool;
+        return NULL;
+    }
+
+    pool->num_threads = num_threads;
+    pool->stop = false;
+    pool->generation = 0;
+    pool->remaining = 0;
+    pool->num_sleeping = 0;
+    try
+    {
+        // Reserved first, so that only the construction of a thread can throw
+        // once one is running.
+        pool->threads.reserve((size_t)num_threads - 1);
+        for (int w = 1; w < num_threads; ++w)
+        {
+            pool->threads.emplace_back(hm_pool_member, pool, w);
+        }
+    }
+    catch (...)
+    {
+        hm_pool_stop(pool);
+        free(pool->slots);
+        delete pool;
+        return NULL;
+    }
+
+    return pool;
+}
+
+// Stops and releases a pool obtained from hm_pool_create(). Passing NULL is
+// allowed and does nothing.
+void hm_pool_free(hm_pool *pool)
+{
+    if (pool)
+    {
+        hm_pool_stop(pool);
+        free(pool->slots);
+        delete pool;
+    }
+}
+
+// Returns the number of members of pool.
+int hm_pool_size(const hm_pool *pool)
+{
+    return pool->num_threads;
+}
+
+// Returns the scratch slot of member w, hm_pool_slot_size bytes aligned as
+// malloc() aligns.
+void *hm_pool_slot(hm_pool *pool, int w)
+{
+    return (char *)pool->slots + (size_t)w * hm_pool_slot_size;
+}
+
+// Runs fn(ctx, w) on every member w of pool, and returns when all have
+// finished. Not reentrant: fn must not itself call hm_pool_run().
+void hm_pool_run(hm_pool *pool, void (*fn)(void *, int), void *ctx)
+{
+    pool->fn = fn;
+    pool->ctx = ctx;
+    pool->remaining.store(pool->num_threads - 1, std::memory_order_relaxed);
+    hm_pool_publish(pool);
+    fn(ctx, 0);
+    while (pool->remaining.load(std::memory_order_acquire) != 0)
+    {
+        std::this_thread::yield();
+    }
+}
@@ -0,0 +1,37 @@
+// Copyright 2010, 2017 William Rummler (w.a.rummler@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HM_POOL_H
+#define HM_POOL_H
+
+// A fixed team of threads that runs one function at a time on every member,
+// the calling thread included, for the parallel phases of a single solve. See
+// hm_pool.cc.
+typedef struct hm_pool_ hm_pool;
+
+// Each member owns a scratch slot of this many bytes, on its own cache line, for
+// the partial results of reductions.
+enum
+{
+    hm_pool_slot_size = 64
+};
+
+hm_pool *hm_pool_create(int);
+void hm_pool_free(hm_pool *);
+int hm_pool_size(const hm_pool *);
+void *hm_pool_slot(hm_pool *, int);
+void hm_pool_run(hm_pool *, void (*)(void *, int), void *);
+
+#endif
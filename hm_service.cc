@@ -0,0 +1,579 @@
+// Copyright 2010, 2017 William Rummler (w.a.rummler@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+// This file contains an in-process service for solving a stream of problems
+// submitted concurrently, such as the requests of a matching server. Where
+// threads calling hungarian_method() each on their own would each allocate a
+// workspace per call, or contend for one, the service keeps a fixed team of
+// workers, each owning its workspaces for good, so that a solve allocates
+// nothing once the service is warm.
+//
+// Requests pass through the bounded multi-producer, multi-consumer queue of
+// Dmitry Vyukov: an array of cells, each with a sequence number telling
+// producers and consumers whose turn it is, and two positions claimed by
+// compare-and-swap. Neither submitting nor taking a request ever blocks on a
+// lock, and a full queue is reported to the submitter rather than waited out,
+// so that overload shows up as rejected requests instead of growing latency.
+//
+// Each worker keeps one workspace per size class, the powers of two from
+// 2^hm_service_min_class up, created when first needed. A request is solved
+// with the workspace of the least class that holds it, so that the arena it
+// touches is no larger than twice its own needs, whatever larger problems the
+// worker solved before.
+//
+// Small problems are coalesced under load: a worker taking one of at most
+// coalesce_n vertices a side, while every other worker is busy too, goes on
+// taking queued requests, up to max_batch or until it takes a large one. It
+// hands the small ones to hungarian_method_batch() with its workspace of their
+// size class, solving on its own thread as the other workers are busy anyway,
+// and then completes them all together, with one wakeup of the waiting
+// submitters for the lot, if there are any. While any worker is idle, requests
+// are left in the queue for it, so that a burst of small requests is spread
+// over the workers rather than serialized on one of them.
+//
+// Workers and waiting submitters spin briefly before sleeping, as the members
+// of hm_pool.cc do, to keep the latency of a busy service low.
+
+#include "hm_service.h"
+#include "hm_batch.h"
+#include "hungarian_method.h"
+#include <cstdlib>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+
+// The number of times a worker polls the empty queue, or a submitter its
+// pending request, before sleeping.
+#define HM_SERVICE_SPIN 1024
+
+enum
+{
+    hm_service_min_class = 4,
+    hm_service_num_classes = 31,
+    hm_service_line = 64 // the size of a cache line
+};
+
+// One cell of the queue.
+struct hm_service_cell
+{
+    std::atomic<size_t> sequence;
+    hm_request *request;
+};
+
+struct hm_service_worker
+{
+    hm_service *service;
+    hm_workspace *ws[hm_service_num_classes]; // by size class, or NULL
+
+    // The requests taken at once, and their arguments to
+    // hungarian_method_batch(), max_batch of each.
+    hm_request **batch;
+    int **mates;
+    const int32_t **costs;
+    int *sizes;
+    std::thread thread;
+};
+
+struct hm_service_
+{
+    // The queue. Its positions are kept on cache lines of their own, as every
+    // producer writes the one and every consumer the other.
+    hm_service_cell *cells;
+    size_t mask;
+    char pad0[hm_service_line];
+    std::atomic<size_t> enqueue_pos;
+    char pad1[hm_service_line];
+    std::atomic<size_t> dequeue_pos;
+    char pad2[hm_service_line];
+
+    int coalesce_n;
+    int max_batch;
+    int num_workers;
+    hm_service_worker *workers;
+    std::atomic<bool> stop;
+    std::atomic<int> num_idle; // workers that have found the queue empty
+
+    // For workers that found the queue empty.
+    std::mutex lock;
+    std::condition_variable wake;
+    std::atomic<int> num_sleeping;
+
+    // For submitters waiting on their requests.
+    std::mutex done_lock;
+    std::condition_variable done_wake;
+    std::atomic<int> num_waiting;
+};
+
+// Appends r to the queue of s. Returns false if the queue is full.
+static bool hm_queue_push(hm_service *s, hm_request *r)
+{
+    hm_service_cell *cell;
+    size_t pos = s->enqueue_pos.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        cell = &s->cells[pos & s->mask];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+        if (dif == 0)
+        {
+            if (s->enqueue_pos.compare_exchange_weak(
+                    pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (dif < 0)
+        {
+            return false; // the cell still holds the request of a lap ago
+        }
+        else
+        {
+            pos = s->enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->request = r;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+// Removes the request at the head of the queue of s into *r. Returns false if
+// the queue is empty.
+static bool hm_queue_pop(hm_service *s, hm_request **r)
+{
+    hm_service_cell *cell;
+    size_t pos = s->dequeue_pos.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        cell = &s->cells[pos & s->mask];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (dif == 0)
+        {
+            if (s->dequeue_pos.compare_exchange_weak(
+                    pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (dif < 0)
+        {
+            return false; // the cell has not been filled this lap
+        }
+        else
+        {
+            pos = s->dequeue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    *r = cell->request;
+    cell->sequence.store(pos + s->mask + 1, std::memory_order_release);
+    return true;
+}
+
+// Returns whether the queue of s holds no published request. A push that has
+// claimed its cell but not yet filled it makes the queue appear nonempty.
+static bool hm_queue_empty(hm_service *s)
+{
+    return s->enqueue_pos.load() == s->dequeue_pos.load();
+}
+
+// Puts a worker of s to sleep until the queue is nonempty or s is stopping.
+// A submitter publishes its request before checking for sleepers, and a worker
+// announces itself as one before checking the queue, so that either the
+// submitter sees the sleeper or the sleeper sees the request.
+static void hm_service_sleep(hm_service *s)
+{
+    std::unique_lock<std::mutex> guard(s->lock);
+    s->num_sleeping.fetch_add(1);
+    while (hm_queue_empty(s) && !s->stop.load())
+    {
+        s->wake.wait(guard);
+    }
+
+    s->num_sleeping.fetch_sub(1);
+}
+
+// Returns the workspace of worker w for problems of n vertices a side,
+// creating it if need be, or NULL if it cannot be created.
+static hm_workspace *hm_service_workspace(hm_service_worker *w, int n)
+{
+    int k = hm_service_min_class;
+    while (k < hm_service_num_classes && ((int64_t)1 << k) < n)
+    {
+        ++k;
+    }
+
+    if (k == hm_service_num_classes)
+    {
+        return NULL;
+    }
+
+    if (!w->ws[k])
+    {
+        w->ws[k] = hm_workspace_create(1 << k);
+    }
+
+    return w->ws[k];
+}
+
+// Sets the cost of r from its solved mate, summed in 64 bits so that the n
+// costs of int32_t cannot overflow it.
+static void hm_service_cost(hm_request *r)
+{
+    int i, n = r->n;
+    int64_t cost = 0;
+    for (i = 0; i < n; ++i)
+    {
+        cost += r->c[(size_t)i * n + r->mate[i] - n];
+    }
+
+    r->cost = cost;
+}
+
+// Solves the count requests taken by worker w, all of them small but perhaps
+// the last, and completes them.
+static void hm_service_solve(hm_service_worker *w, int count)
+{
+    hm_request *r, *last = w->batch[count - 1];
+    hm_workspace *ws;
+    int k, n = 0, state;
+    int num_small = last->n <= w->service->coalesce_n ? count : count - 1;
+    for (k = 0; k < num_small; ++k)
+    {
+        r = w->batch[k];
+        w->mates[k] = r->mate;
+        w->costs[k] = r->c;
+        w->sizes[k] = r->n;
+        n = r->n > n ? r->n : n;
+    }
+
+    // The small requests go through the batched front end together, and a
+    // large one is solved alone.
+    bool small_ok = !num_small
+        || ((ws = hm_service_workspace(w, n))
+            && hungarian_method_batch(ws, num_small, w->mates, w->costs,
+                                      w->sizes));
+    bool large_ok = num_small == count
+        || (ws = hm_service_workspace(w, last->n)) != NULL;
+    if (num_small < count && large_ok)
+    {
+        hungarian_method(ws, last->mate, last->c, last->n);
+    }
+
+    for (k = 0; k < count; ++k)
+    {
+        r = w->batch[k];
+        state = (k < num_small ? small_ok : large_ok) ? hm_request_done
+                                                      : hm_request_failed;
+        if (state == hm_request_done)
+        {
+            hm_service_cost(r);
+        }
+
+        if (r->done)
+        {
+            r->done(r);
+        }
+
+        // The request belongs to its submitter again from here on.
+        r->state.store(state);
+    }
+}
+
+// The body of worker w: take requests, coalescing small ones, and solve and
+// complete them, until the service stops and its queue is empty.
+static void hm_service_work(hm_service_worker *w)
+{
+    hm_service *s = w->service;
+    int count, spin = 0;
+    bool idle = false;
+    for (;;)
+    {
+        if (!hm_queue_pop(s, &w->batch[0]))
+        {
+            if (s->stop.load(std::memory_order_acquire))
+            {
+                return;
+            }
+
+            if (!idle)
+            {
+                s->num_idle.fetch_add(1);
+                idle = true;
+            }
+
+            if (++spin < HM_SERVICE_SPIN)
+            {
+                std::this_thread::yield();
+            }
+            else
+            {
+                hm_service_sleep(s);
+                spin = 0;
+            }
+
+            continue;
+        }
+
+        if (idle)
+        {
+            s->num_idle.fetch_sub(1);
+            idle = false;
+        }
+
+        count = 1;
+        while (count < s->max_batch && w->batch[count - 1]->n <= s->coalesce_n
+               && s->num_idle.load(std::memory_order_relaxed) == 0
+               && hm_queue_pop(s, &w->batch[count]))
+        {
+            ++count;
+        }
+
+        // See hm_service_wait(). Without sleeping waiters there is no one to
+        // wake, so a busy service makes no wake call per batch.
+        hm_service_solve(w, count);
+        if (s->num_waiting.load() > 0)
+        {
+            {
+                std::lock_guard<std::mutex> guard(s->done_lock);
+            }
+
+            s->done_wake.notify_all();
+        }
+
+        spin = 0;
+    }
+}
+
+// Sets options to their defaults: a worker per hardware thread, a queue of 1024
+// requests, and small problems, those solved by the fixed-size solver of
+// hungarian_method.cc, coalesced 16 at a time.
+void hm_service_options_init(hm_service_options *options)
+{
+    options->num_threads = 0;
+    options->queue_capacity = 1024;
+    options->coalesce_n = 16;
+    options->max_batch = 16;
+}
+
+// Creates a service with the given options, or the defaults if options is
+// NULL, and starts its workers. Returns NULL if an option is out of range or
+// memory is unavailable.
+hm_service *hm_service_create(const hm_service_options *options)
+{
+    hm_service_options defaults;
+    if (!options)
+    {
+        hm_service_options_init(&defaults);
+        options = &defaults;
+    }
+
+    if (options->queue_capacity < 1 || options->queue_capacity > (1 << 30)
+        || options->max_batch < 1)
+    {
+        return NULL;
+    }
+
+    hm_service *s = new (std::nothrow) hm_service_;
+    if (!s)
+    {
+        return NULL;
+    }
+
+    int w, num_workers = options->num_threads;
+    if (num_workers <= 0)
+    {
+        num_workers = (int)std::thread::hardware_concurrency();
+    }
+
+    num_workers = num_workers < 1 ? 1 : num_workers;
+    size_t i, capacity = 1;
+    while (capacity < (size_t)options->queue_capacity)
+    {
+        capacity *= 2;
+    }
+
+    s->cells = new (std::nothrow) hm_service_cell[capacity];
+    s->workers = new (std::nothrow) hm_service_worker[num_workers];
+    bool ok = s->cells && s->workers;
+    for (w = 0; s->workers && w < num_workers; ++w)
+    {
+        s->workers[w].batch = NULL;
+    }
+
+    // The pointer arrays of a worker come first in its block, so that they
+    // are suitably aligned.
+    size_t batch = (size_t)options->max_batch;
+    for (w = 0; ok && w < num_workers; ++w)
+    {
+        hm_service_worker *worker = &s->workers[w];
+        worker->batch = (hm_request **)malloc(
+            batch * (sizeof(hm_request *) + sizeof(int *)
+                     + sizeof(const int32_t *) + sizeof(int)));
+        ok = worker->batch != NULL;
+        if (ok)
+        {
+            worker->mates = (int **)(worker->batch + batch);
+            worker->costs = (const int32_t **)(worker->mates + batch);
+            worker->sizes = (int *)(worker->costs + batch);
+        }
+    }
+
+    if (!ok)
+    {
+        for (w = 0; s->workers && w < num_workers; ++w)
+        {
+            free(s->workers[w].batch);
+        }
+
+        delete[] s->cells;
+        delete[] s->workers;
+        delete s;
+        return NULL;
+    }
+
+    for (i = 0; i < capacity; ++i)
+    {
+        s->cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    s->mask = capacity - 1;
+    s->enqueue_pos = 0;
+    s->dequeue_pos = 0;
+    s->coalesce_n = options->coalesce_n;
+    s->max_batch = options->max_batch;
+    s->num_workers = num_workers;
+    s->stop = false;
+    s->num_idle = 0;
+    s->num_sleeping = 0;
+    s->num_waiting = 0;
+    for (w = 0; w < num_workers; ++w)
+    {
+        hm_service_worker *worker = &s->workers[w];
+        worker->service = s;
+        for (int k = 0; k < hm_service_num_classes; ++k)
+        {
+            worker->ws[k] = NULL;
+        }
+
+        worker->thread = std::thread(hm_service_work, worker);
+    }
+
+    return s;
+}
+
+// Stops and releases a service obtained from hm_service_create(), once its
+// workers have completed every request already submitted. No request may be
+// submitted meanwhile. Passing NULL is allowed and does nothing.
+void hm_service_free(hm_service *s)
+{
+    int w, k;
+    if (!s)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(s->lock);
+        s->stop.store(true);
+    }
+
+    s->wake.notify_all();
+    for (w = 0; w < s->num_workers; ++w)
+    {
+        s->workers[w].thread.join();
+        for (k = 0; k < hm_service_num_classes; ++k)
+        {
+            hm_workspace_free(s->workers[w].ws[k]);
+        }
+
+        free(s->workers[w].batch);
+    }
+
+    delete[] s->cells;
+    delete[] s->workers;
+    delete s;
+}
+
+// Prepares r to solve the n*n costs c into mate, as hungarian_method() does,
+// with no completion callback.
+void hm_request_init(hm_request *r, const int32_t *c, int n, int *mate)
+{
+    r->c = c;
+    r->n = n;
+    r->mate = mate;
+    r->done = NULL;
+    r->context = NULL;
+    r->cost = 0;
+    r->state.store(hm_request_pending, std::memory_order_relaxed);
+}
+
+// Queues r to be solved by a worker of s, which fills r->mate and r->cost and
+// then calls r->done, if set, on the worker's thread. done must not release r:
+// the request is the service's until its state leaves hm_request_pending, after
+// done returns. Returns false if the queue is full, in which case r is marked
+// pending but not queued, for the caller to submit again or reject.
+bool hm_service_submit(hm_service *s, hm_request *r)
+{
+    r->state.store(hm_request_pending, std::memory_order_relaxed);
+    if (!hm_queue_push(s, r))
+    {
+        return false;
+    }
+
+    // See hm_service_sleep().
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (s->num_sleeping.load() > 0)
+    {
+        {
+            std::lock_guard<std::mutex> guard(s->lock);
+        }
+
+        s->wake.notify_one();
+    }
+
+    return true;
+}
+
+// Waits for r, submitted to s, to complete, as on a future. Returns its final
+// state, hm_request_done or hm_request_failed.
+int hm_service_wait(hm_service *s, hm_request *r)
+{
+    int spin, state;
+    for (spin = 0; spin < HM_SERVICE_SPIN; ++spin)
+    {
+        if ((state = r->state.load(std::memory_order_acquire))
+            != hm_request_pending)
+        {
+            return state;
+        }
+
+        std::this_thread::yield();
+    }
+
+    // As in hm_service_sleep(), the waiter announces itself before checking,
+    // and a worker completes its requests before checking for waiters.
+    std::unique_lock<std::mutex> guard(s->done_lock);
+    s->num_waiting.fetch_add(1);
+    while ((state = r->state.load()) == hm_request_pending)
+    {
+        s->done_wake.wait(guard);
+    }
+
+    s->num_waiting.fetch_sub(1);
+    return state;
+}
@@ -0,0 +1,68 @@
+// Copyright 2010, 2017 William Rummler (w.a.rummler@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HM_SERVICE_H
+#define HM_SERVICE_H
+
+#include <stdint.h>
+#include <atomic>
+
+// An in-process solving service: a fixed team of worker threads, each keeping
+// its own workspaces, serving requests from a lock-free queue shared by any
+// number of submitting threads. See hm_service.cc.
+typedef struct hm_service_ hm_service;
+typedef struct hm_service_options_ hm_service_options;
+typedef struct hm_request_ hm_request;
+
+struct hm_service_options_
+{
+    int num_threads;    // workers, zero or less for one per hardware thread
+    int queue_capacity; // requests queued at most, rounded up to a power of 2
+    int coalesce_n;     // the greatest n of a request coalesced with others
+    int max_batch;      // the most requests a worker takes at once
+};
+
+// The states of a request.
+enum
+{
+    hm_request_pending,
+    hm_request_done,
+    hm_request_failed // memory for a workspace was unavailable
+};
+
+// A request to solve one problem. The caller owns it, and it must stay alive,
+// unmoved and with its costs unchanged, until it completes.
+struct hm_request_
+{
+    // Set by the caller, e.g. with hm_request_init().
+    const int32_t *c;
+    int n;
+    int *mate;
+    void (*done)(hm_request *); // called by the worker on completion, or NULL
+    void *context;              // for the caller's use, e.g. by done
+
+    // Set by the service.
+    int64_t cost; // the cost of mate, once done
+    std::atomic<int> state;
+};
+
+void hm_service_options_init(hm_service_options *);
+hm_service *hm_service_create(const hm_service_options *);
+void hm_service_free(hm_service *);
+
+void hm_request_init(hm_request *, const int32_t *, int, int *);
+bool hm_service_submit(hm_service *, hm_request *);
+int hm_service_wait(hm_service *, hm_request *);
+
+#endif
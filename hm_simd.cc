@@ -0,0 +1,496 @@
+// Copyright 2010, 2017 William Rummler (w.a.rummler@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <http://www.gnu.org/licenses/>.
+
+// This file contains scalar, AVX2, AVX-512, and NEON versions of the kernels
+// declared in hm_simd.h, along with the run-time selection among them. Each
+// vector kernel handles whole vectors and leaves any remainder to the scalar
+// kernel. Defining HM_NO_SIMD at compile time leaves only the scalar kernels.
+//
+// The NEON kernels have yet to be compiled and run against the scalar ones on
+// an ARM64 machine, so they are left out of the build unless HM_NEON is defined
+// at compile time. Whoever first builds them should run test_simd() in
+// hm_test.cc there before making them the default.
+
+#include "hm_simd.h"
+#include <cstring>
+#include <limits.h>
+
+#if !defined(HM_NO_SIMD) && (defined(__x86_64__) || defined(__i386__) || \
+                             defined(_M_X64) || defined(_M_IX86))
+#define HM_SIMD_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if !defined(HM_NO_SIMD) && defined(HM_NEON) && \
+    (defined(__aarch64__) || defined(_M_ARM64))
+#define HM_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+// GCC and Clang only emit instructions of an extension within functions that
+// are marked as targeting it; MSVC accepts the intrinsics anywhere.
+#if defined(__GNUC__)
+#define HM_TARGET(isa_) __attribute__((target(isa_)))
+#else
+#define HM_TARGET(isa_)
+#endif
+
+// The same "blank" value as hungarian_method.cc.
+enum
+{
+    blank = -1
+};
+
+// The scalar kernels, which are also used for the remainder of each vector
+// kernel's input.
+static int theta_scalar(const int *slack, int n)
+{
+    int k, theta = INT_MAX;
+    for (k = 0; k < n; ++k)
+    {
+        if (0 < slack[k] && slack[k] < theta)
+        {
+            theta = slack[k];
+        }
+    }
+
+    return theta;
+}
+
+static void update_slack_scalar(const int *c, int scale, int alpha,
+                                const int *beta, int *slack, int *nhbor, int z,
+                                int n)
+{
+    int k, tmp;
+    for (k = 0; k < n; ++k)
+    {
+        tmp = scale * c[k] - alpha - beta[k];
+        if (0 <= tmp && tmp < slack[k])
+        {
+            slack[k] = tmp;
+            nhbor[k] = z;
+        }
+    }
+}
+
+static void update_duals_scalar(int *alpha, const int *label, const int *mate,
+                                int *beta, const int *slack, int theta, int n)
+{
+    int k;
+    for (k = 0; k < n; ++k)
+    {
+        alpha[k] += label[k] != blank || mate[k] == blank ? theta : -theta;
+    }
+
+    for (k = 0; k < n; ++k)
+    {
+        beta[k] += slack[k] == 0 ? -theta : theta;
+    }
+}
+
+static const hm_simd_kernels scalar_kernels = {
+    "scalar", theta_scalar, update_slack_scalar, update_duals_scalar
+};
+
+#if defined(HM_SIMD_X86)
+HM_TARGET("avx2")
+static int theta_avx2(const int *slack, int n)
+{
+    int k, lanes[8], theta;
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i none = _mm256_set1_epi32(INT_MAX);
+    __m256i vmin = none;
+    for (k = 0; k + 8 <= n; k += 8)
+    {
+        __m256i s = _mm256_loadu_si256((const __m256i *)(slack + k));
+        __m256i positive = _mm256_cmpgt_epi32(s, zero);
+        vmin = _mm256_min_epi32(vmin, _mm256_blendv_epi8(none, s, positive));
+    }
+
+    _mm256_storeu_si256((__m256i *)lanes, vmin);
+    theta = theta_scalar(slack + k, n - k);
+    for (k = 0; k < 8; ++k)
+    {
+        if (lanes[k] < theta)
+        {
+            theta = lanes[k];
+        }
+    }
+
+    return theta;
+}
+
+HM_TARGET("avx2")
+static void update_slack_avx2(const int *c, int scale, int alpha,
+                              const int *beta, int *slack, int *nhbor,
+                              int z, int n)
+{
+    int k;
+    const __m256i a = _mm256_set1_epi32(alpha);
+    const __m256i vz = _mm256_set1_epi32(z);
+    const __m256i minus_one = _mm256_set1_epi32(-1);
+    const __m256i negate = _mm256_set1_epi32(scale < 0 ? -1 : 0);
+    for (k = 0; k + 8 <= n; k += 8)
+    {
+        __m256i ck = _mm256_loadu_si256((const __m256i *)(c + k));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(beta + k));
+        __m256i s = _mm256_loadu_si256((const __m256i *)(slack + k));
+        __m256i nh = _mm256_loadu_si256((const __m256i *)(nhbor + k));
+        ck = _mm256_add_epi32(ck, ck);
+        ck = _mm256_sub_epi32(_mm256_xor_si256(ck, negate), negate);
+        __m256i tmp = _mm256_sub_epi32(_mm256_sub_epi32(ck, a), b);
+        __m256i better = _mm256_and_si256(_mm256_cmpgt_epi32(tmp, minus_one),
+                                          _mm256_cmpgt_epi32(s, tmp));
+        _mm256_storeu_si256((__m256i *)(slack + k),
+                            _mm256_blendv_epi8(s, tmp, better));
+        _mm256_storeu_si256((__m256i *)(nhbor + k),
+                            _mm256_blendv_epi8(nh, vz, better));
+    }
+
+    update_slack_scalar(c + k, scale, alpha, beta + k, slack + k, nhbor + k, z,
+                        n - k);
+}
+
+HM_TARGET("avx2")
+static void update_duals_avx2(int *alpha, const int *label, const int *mate,
+                              int *beta, const int *slack, int theta, int n)
+{
+    int k;
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i minus_one = _mm256_set1_epi32(blank);
+    const __m256i up = _mm256_set1_epi32(theta);
+    const __m256i down = _mm256_set1_epi32(-theta);
+    for (k = 0; k + 8 <= n; k += 8)
+    {
+        __m256i l = _mm256_loadu_si256((const __m256i *)(label + k));
+        __m256i m = _mm256_loadu_si256((const __m256i *)(mate + k));
+        __m256i a = _mm256_loadu_si256((const __m256i *)(alpha + k));
+        __m256i unlabeled = _mm256_andnot_si256(_mm256_cmpeq_epi32(m, minus_one),
+                                                _mm256_cmpeq_epi32(l, minus_one));
+        a = _mm256_add_epi32(a, _mm256_blendv_epi8(up, down, unlabeled));
+        _mm256_storeu_si256((__m256i *)(alpha + k), a);
+    }
+
+    for (; k < n; ++k)
+    {
+        alpha[k] += label[k] != blank || mate[k] == blank ? theta : -theta;
+    }
+
+    for (k = 0; k + 8 <= n; k += 8)
+    {
+        __m256i s = _mm256_loadu_si256((const __m256i *)(slack + k));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(beta + k));
+        __m256i tight = _mm256_cmpeq_epi32(s, zero);
+        b = _mm256_add_epi32(b, _mm256_blendv_epi8(up, down, tight));
+        _mm256_storeu_si256((__m256i *)(beta + k), b);
+    }
+
+    for (; k < n; ++k)
+    {
+        beta[k] += slack[k] == 0 ? -theta : theta;
+    }
+}
+
+static const hm_simd_kernels avx2_kernels = {
+    "avx2", theta_avx2, update_slack_avx2, update_duals_avx2
+};
+
+HM_TARGET("avx512f")
+static int theta_avx512(const int *slack, int n)
+{
+    int k, lanes[16], theta;
+    const __m512i zero = _mm512_setzero_si512();
+    __m512i vmin = _mm512_set1_epi32(INT_MAX);
+    for (k = 0; k + 16 <= n; k += 16)
+    {
+        __m512i s = _mm512_loadu_si512((const void *)(slack + k));
+        __mmask16 positive = _mm512_cmpgt_epi32_mask(s, zero);
+        vmin = _mm512_mask_min_epi32(vmin, positive, vmin, s);
+    }
+
+    _mm512_storeu_si512((void *)lanes, vmin);
+    theta = theta_scalar(slack + k, n - k);
+    for (k = 0; k < 16; ++k)
+    {
+        if (lanes[k] < theta)
+        {
+            theta = lanes[k];
+        }
+    }
+
+    return theta;
+}
+
+HM_TARGET("avx512f")
+static void update_slack_avx512(const int *c, int scale, int alpha,
+                                const int *beta, int *slack, int *nhbor,
+                                int z, int n)
+{
+    int k;
+    const __m512i a = _mm512_set1_epi32(alpha);
+    const __m512i vz = _mm512_set1_epi32(z);
+    const __m512i minus_one = _mm512_set1_epi32(-1);
+    const __m512i negate = _mm512_set1_epi32(scale < 0 ? -1 : 0);
+    for (k = 0; k + 16 <= n; k += 16)
+    {
+        __m512i ck = _mm512_loadu_si512((const void *)(c + k));
+        __m512i b = _mm512_loadu_si512((const void *)(beta + k));
+        __m512i s = _mm512_loadu_si512((const void *)(slack + k));
+        ck = _mm512_add_epi32(ck, ck);
+        ck = _mm512_sub_epi32(_mm512_xor_si512(ck, negate), negate);
+        __m512i tmp = _mm512_sub_epi32(_mm512_sub_epi32(ck, a), b);
+        __mmask16 better = _mm512_mask_cmpgt_epi32_mask(
+            _mm512_cmpgt_epi32_mask(tmp, minus_one), s, tmp);
+        _mm512_mask_storeu_epi32((void *)(slack + k), better, tmp);
+        _mm512_mask_storeu_epi32((void *)(nhbor + k), better, vz);
+    }
+
+    update_slack_scalar(c + k, scale, alpha, beta + k, slack + k, nhbor + k, z,
+                        n - k);
+}
+
+HM_TARGET("avx512f")
+static void update_duals_avx512(int *alpha, const int *label, const int *mate,
+                                int *beta, const int *slack, int theta, int n)
+{
+    int k;
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i minus_one = _mm512_set1_epi32(blank);
+    const __m512i up = _mm512_set1_epi32(theta);
+    for (k = 0; k + 16 <= n; k += 16)
+    {
+        __m512i l = _mm512_loadu_si512((const void *)(label + k));
+        __m512i m = _mm512_loadu_si512((const void *)(mate + k));
+        __m512i a = _mm512_loadu_si512((const void *)(alpha + k));
+        __mmask16 labeled = _mm512_cmpneq_epi32_mask(l, minus_one) |
+                            _mm512_cmpeq_epi32_mask(m, minus_one);
+        a = _mm512_mask_blend_epi32(labeled, _mm512_sub_epi32(a, up),
+                                    _mm512_add_epi32(a, up));
+        _mm512_storeu_si512((void *)(alpha + k), a);
+    }
+
+    for (; k < n; ++k)
+    {
+        alpha[k] += label[k] != blank || mate[k] == blank ? theta : -theta;
+    }
+
+    for (k = 0; k + 16 <= n; k += 16)
+    {
+        __m512i s = _mm512_loadu_si512((const void *)(slack + k));
+        __m512i b = _mm512_loadu_si512((const void *)(beta + k));
+        __mmask16 tight = _mm512_cmpeq_epi32_mask(s, zero);
+        b = _mm512_mask_blend_epi32(tight, _mm512_add_epi32(b, up),
+                                    _mm512_sub_epi32(b, up));
+        _mm512_storeu_si512((void *)(beta + k), b);
+    }
+
+    for (; k < n; ++k)
+    {
+        beta[k] += slack[k] == 0 ? -theta : theta;
+    }
+}
+
+static const hm_simd_kernels avx512_kernels = {
+    "avx512", theta_avx512, update_slack_avx512, update_duals_avx512
+};
+
+// Reports whether the CPU and OS support the given extension.
+static bool cpu_supports_avx2(void)
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    if (!(info[2] & (1 << 27)) || (_xgetbv(0) & 0x6) != 0x6)
+    {
+        return false;
+    }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+static bool cpu_supports_avx512(void)
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    if (!(info[2] & (1 << 27)) || (_xgetbv(0) & 0xE6) != 0xE6)
+    {
+        return false;
+    }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 16)) != 0;
+#else
+    return __builtin_cpu_supports("avx512f");
+#endif
+}
+#endif
+
+#if defined(HM_SIMD_NEON)
+static int theta_neon(const int *slack, int n)
+{
+    int k, theta, rest;
+    const int32x4_t zero = vdupq_n_s32(0);
+    const int32x4_t none = vdupq_n_s32(INT_MAX);
+    int32x4_t vmin = none;
+    for (k = 0; k + 4 <= n; k += 4)
+    {
+        int32x4_t s = vld1q_s32(slack + k);
+        vmin = vminq_s32(vmin, vbslq_s32(vcgtq_s32(s, zero), s, none));
+    }
+
+    theta = vminvq_s32(vmin);
+    rest = theta_scalar(slack + k, n - k);
+    return rest < theta ? rest : theta;
+}
+
+static void update_slack_neon(const int *c, int scale, int alpha,
+                              const int *beta, int *slack, int *nhbor,
+                              int z, int n)
+{
+    int k;
+    const int32x4_t a = vdupq_n_s32(alpha);
+    const int32x4_t vz = vdupq_n_s32(z);
+    const int32x4_t zero = vdupq_n_s32(0);
+    const int32x4_t negate = vdupq_n_s32(scale < 0 ? -1 : 0);
+    for (k = 0; k + 4 <= n; k += 4)
+    {
+        int32x4_t ck = vld1q_s32(c + k);
+        int32x4_t s = vld1q_s32(slack + k);
+        ck = vaddq_s32(ck, ck);
+        ck = vsubq_s32(veorq_s32(ck, negate), negate);
+        int32x4_t tmp = vsubq_s32(vsubq_s32(ck, a), vld1q_s32(beta + k));
+        uint32x4_t better = vandq_u32(vcgeq_s32(tmp, zero), vcltq_s32(tmp, s));
+        vst1q_s32(slack + k, vbslq_s32(better, tmp, s));
+        vst1q_s32(nhbor + k, vbslq_s32(better, vz, vld1q_s32(nhbor + k)));
+    }
+
+    update_slack_scalar(c + k, scale, alpha, beta + k, slack + k, nhbor + k, z,
+                        n - k);
+}
+
+static void update_duals_neon(int *alpha, const int *label, const int *mate,
+                              int *beta, const int *slack, int theta, int n)
+{
+    int k;
+    const int32x4_t zero = vdupq_n_s32(0);
+    const int32x4_t minus_one = vdupq_n_s32(blank);
+    const int32x4_t up = vdupq_n_s32(theta);
+    const int32x4_t down = vdupq_n_s32(-theta);
+    for (k = 0; k + 4 <= n; k += 4)
+    {
+        uint32x4_t labeled =
+            vorrq_u32(vmvnq_u32(vceqq_s32(vld1q_s32(label + k), minus_one)),
+                      vceqq_s32(vld1q_s32(mate + k), minus_one));
+        vst1q_s32(alpha + k, vaddq_s32(vld1q_s32(alpha + k),
+                                       vbslq_s32(labeled, up, down)));
+    }
+
+    for (; k < n; ++k)
+    {
+        alpha[k] += label[k] != blank || mate[k] == blank ? theta : -theta;
+    }
+
+    for (k = 0; k + 4 <= n; k += 4)
+    {
+        uint32x4_t tight = vceqq_s32(vld1q_s32(slack + k), zero);
+        vst1q_s32(beta + k, vaddq_s32(vld1q_s32(beta + k),
+                                      vbslq_s32(tight, down, up)));
+    }
+
+    for (; k < n; ++k)
+    {
+        beta[k] += slack[k] == 0 ? -theta : theta;
+    }
+}
+
+static const hm_simd_kernels neon_kernels = {
+    "neon", theta_neon, update_slack_neon, update_duals_neon
+};
+#endif
+
+// Returns the kernels for the widest instruction set available at run time.
+static const hm_simd_kernels *detect(void)
+{
+#if defined(HM_SIMD_X86)
+    if (cpu_supports_avx512())
+    {
+        return &avx512_kernels;
+    }
+
+    if (cpu_supports_avx2())
+    {
+        return &avx2_kernels;
+    }
+#elif defined(HM_SIMD_NEON)
+    return &neon_kernels;
+#endif
+    return &scalar_kernels;
+}
+
+// The current selection, detected once in a thread-safe manner on first use.
+static const hm_simd_kernels *&selection(void)
+{
+    static const hm_simd_kernels *selected = detect();
+    return selected;
+}
+
+const hm_simd_kernels *hm_simd(void)
+{
+    return selection();
+}
+
+const hm_simd_kernels *hm_simd_find(const char *name)
+{
+    if (!strcmp(name, "scalar"))
+    {
+        return &scalar_kernels;
+    }
+#if defined(HM_SIMD_X86)
+    if (!strcmp(name, "avx2") && cpu_supports_avx2())
+    {
+        return &avx2_kernels;
+    }
+
+    if (!strcmp(name, "avx512") && cpu_supports_avx512())
+    {
+        return &avx512_kernels;
+    }
+#elif defined(HM_SIMD_NEON)
+    if (!strcmp(name, "neon"))
+    {
+        return &neon_kernels;
+    }
+#endif
+    return NULL;
+}
+
+bool hm_simd_select(const char *name)
+{
+    const hm_simd_kernels *k = hm_simd_find(name);
+    if (!k)
+    {
+        return false;
+    }
+
+    selection() = k;
+    return true;
+}
@@ -0,0 +1,61 @@
+// Copyright 2010, 2017 William Rummler (w.a.rummler@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HM_SIMD_H
+#define HM_SIMD_H
+
+// Vectorized kernels for the O(n) loops of the Hungarian method on int costs.
+// All arrays passed to a kernel are indexed from zero, so that U-side arrays
+// are passed as, e.g., &BETA(N). Every kernel produces exactly the result of
+// the scalar loop it replaces in hungarian_method.cc.
+typedef struct hm_simd_kernels_ hm_simd_kernels;
+
+struct hm_simd_kernels_
+{
+    const char *name;
+
+    // Returns the least positive slack[k], or INT_MAX if there is none. See
+    // hm_modify().
+    int (*theta)(const int *slack, int n);
+
+    // For each k, computes tmp = scale * c[k] - alpha - beta[k], where scale is
+    // 2 or -2, and, where 0 <= tmp < slack[k], sets slack[k] = tmp and nhbor[k]
+    // = z. See hm_update_slack().
+    void (*update_slack)(const int *c, int scale, int alpha, const int *beta,
+                         int *slack, int *nhbor, int z, int n);
+
+    // Adds theta to alpha[i] when label[i] or mate[i] marks i as labeled and
+    // subtracts it otherwise, then subtracts theta from beta[k] when slack[k]
+    // is zero and adds it otherwise. See hm_modify().
+    void (*update_duals)(int *alpha, const int *label, const int *mate,
+                         int *beta, const int *slack, int theta, int n);
+};
+
+// Returns the kernels selected for the running CPU. The choice is made once,
+// on first use, from the widest instruction set the CPU and OS support.
+const hm_simd_kernels *hm_simd(void);
+
+// Returns the kernels of the given name ("scalar", "avx2", "avx512", or
+// "neon"), or NULL if they are unavailable on the running CPU or left out of
+// the build, as the NEON kernels are unless HM_NEON is defined, without
+// changing the selection, e.g. to compare them against each other.
+const hm_simd_kernels *hm_simd_find(const char *);
+
+// Overrides the selection with the kernels of the given name, as named for
+// hm_simd_find(), e.g. for benchmarking. Returns false, leaving the selection
+// unchanged, if such kernels are unavailable. Not thread-safe with respect to
+// concurrent solves.
+bool hm_simd_select(const char *);
+
+#endif
@@ -13,21 +13,68 @@
 // this program. If not, see <http://www.gnu.org/licenses/>.
 
 // This file contains a very basic hard-coded harness for testing the
-// implementation found in hungarian_method.c against the "brute force"
-// implementation found in brute_force_assignment.c for solving the assignment
-// problem.
+// implementations found in hungarian_method.c and jonker_volgenant.cc against
+// the "brute force" implementation found in brute_force_assignment.c for
+// solving the assignment problem.
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstdio>
 #include <cstring>
 #include <ctime>
+#include <limits.h>
+#include <limits>
 
+#include "auction_assignment.h"
 #include "brute_force_assignment.h"
+#include "hm_batch.h"
+#include "hm_capi.h"
+#include "hm_cost_file.h"
+#include "hm_oracle.h"
+#include "hm_service.h"
+#include "hm_simd.h"
 #include "hungarian_method.h"
+#include "jonker_volgenant.h"
+#include "ranked_assignment.h"
+#include "sparse_assignment.h"
 
 #define TEST_DIM 8
 #define NUM_TESTS 1000
 #define MAX_COST 100
+#define BATCH_SIZE 256
+#define BATCH_MAX_DIM 32
+#define BATCH_THREADS 4
+#define NUM_RECT_TESTS 200
+#define RECT_MAX_DIM 24
+#define NUM_SPARSE_TESTS 200
+#define SPARSE_DENSITY 30
+#define NUM_WARM_TESTS 200
+#define WARM_CHANGES 3
+#define NUM_DYNAMIC_TESTS 20
+#define DYNAMIC_OPS 50
+#define NUM_AUCTION_TESTS 50
+#define NUM_PARALLEL_TESTS 50
+#define NUM_WIDE_TESTS 200
+#define NUM_MAXIMIZE_TESTS 200
+#define NUM_ORACLE_TESTS 200
+#define NUM_FILE_TESTS 20
+#define FILE_PATH "hm_test_costs.bin"
+#define NUM_RANKED_TESTS 50
+#define RANKED_MAX_DIM 6
+#define RANKED_K 30
+#define NUM_STATS_TESTS 50
+#define NUM_BRUTE_TESTS 20
+#define BRUTE_MAX_DIM 12
+#define NUM_BOUNDED_TESTS 200
+#define NUM_FIXED_TESTS 200
+#define FIXED_MAX_DIM 16
+#define NUM_CAPI_TESTS 50
+#define NUM_SOLUTION_TESTS 200
+#define CAPI_BATCH 8
+#define NUM_SERVICE_TESTS 200
+#define NUM_SIMD_TESTS 200
+#define SIMD_MAX_DIM 67
+#define SERVICE_QUEUE 16
 
 // This function will fill the n*n cost matrix c with random values between one
 // and MAX_COST.
@@ -56,6 +103,1186 @@ static int compute_cost(int *mate, int *c, int n)
     return cost;
 }
 
+// This function fills the n*n matrix d with the entries of the n*n cost matrix
+// c, for exercising the floating-point instantiation of the Hungarian method.
+static void copy_to_double(double *d, int *c, int n)
+{
+    int i;
+    for (i = 0; i < n * n; ++i)
+    {
+        d[i] = c[i];
+    }
+}
+
+// This function solves the n*n cost matrix c by the stages of Figure 11-2 even
+// when n is small enough for hungarian_method() to hand the problem to its
+// fixed-size solver, by solving in the bounded mode with neither a budget nor
+// limits, which always runs those stages.
+template <typename T>
+static void solve_by_stages(hm_workspace *ws, int *mate, const T *c, int n)
+{
+    T bound;
+    hungarian_method_bounded(ws, mate, c, n, std::numeric_limits<T>::max(),
+                             (const hm_limits *)NULL, &bound);
+}
+
+// This function returns a random int in [lo, hi], drawing 15 bits at a time
+// from rand(), whose range may be as small as that.
+static int random_between(int lo, int hi)
+{
+    uint64_t r = 0;
+    for (int k = 0; k < 4; ++k)
+    {
+        r = r << 15 | (rand() & 0x7fff);
+    }
+
+    return (int)(lo + (int64_t)(r % ((uint64_t)((int64_t)hi - lo) + 1)));
+}
+
+// This function runs the kernels of hm_simd.h for every instruction set
+// available on the running CPU against the scalar kernels, on random inputs of
+// every length up to SIMD_MAX_DIM, so that each vector width leaves remainders,
+// and with values up to the limits the solver allows: slacks of INT_MAX (INF)
+// and just below it, and duals as close to INT_MIN and INT_MAX as theta
+// permits. It returns the number of inputs on which some kernel disagrees.
+static int test_simd(void)
+{
+    static const char *const names[] = { "avx2", "avx512", "neon" };
+    int test, n, k, v, z, alpha, theta, scale, num_fail = 0;
+    int c[SIMD_MAX_DIM], beta[SIMD_MAX_DIM], label[SIMD_MAX_DIM];
+    int mate[SIMD_MAX_DIM], slack[SIMD_MAX_DIM], nhbor[SIMD_MAX_DIM];
+    int alphas[SIMD_MAX_DIM];
+
+    // The outputs of the scalar kernels (index 0) and a vector one (index 1).
+    int out_slack[2][SIMD_MAX_DIM], out_nhbor[2][SIMD_MAX_DIM];
+    int out_alpha[2][SIMD_MAX_DIM], out_beta[2][SIMD_MAX_DIM];
+    const hm_simd_kernels *kernels[2];
+    kernels[0] = hm_simd_find("scalar");
+    for (test = 1; test <= NUM_SIMD_TESTS; ++test)
+    {
+        n = (test - 1) % SIMD_MAX_DIM + 1;
+        z = rand() % n;
+        scale = rand() % 2 ? 2 : -2;
+        theta = random_between(1, INT_MAX / 4);
+
+        // |c[k]| < 2^29 and |alpha|, |beta[k]| < 2^29 keep every tmp of
+        // update_slack within an int.
+        alpha = random_between(-(1 << 29) + 1, (1 << 29) - 1);
+        for (k = 0; k < n; ++k)
+        {
+            c[k] = random_between(-(1 << 29) + 1, (1 << 29) - 1);
+            beta[k] = random_between(-(1 << 29) + 1, (1 << 29) - 1);
+            switch (rand() % 4)
+            {
+            case 0:
+                slack[k] = INT_MAX;
+                break;
+            case 1:
+                slack[k] = INT_MAX - 1 - rand() % 4;
+                break;
+            case 2:
+                slack[k] = 0;
+                break;
+            default:
+                slack[k] = random_between(0, INT_MAX);
+            }
+
+            nhbor[k] = rand() % 2 ? -1 : rand() % n;
+            label[k] = rand() % 2 ? -1 : rand() % n;
+            mate[k] = rand() % 2 ? -1 : rand() % n;
+            switch (rand() % 3)
+            {
+            case 0:
+                alphas[k] = INT_MAX - theta;
+                break;
+            case 1:
+                alphas[k] = INT_MIN + theta;
+                break;
+            default:
+                alphas[k] = random_between(INT_MIN + theta, INT_MAX - theta);
+            }
+        }
+
+        bool fail = false;
+        for (v = 0; v < (int)(sizeof(names) / sizeof(*names)); ++v)
+        {
+            if (!(kernels[1] = hm_simd_find(names[v])))
+            {
+                continue;
+            }
+
+            for (k = 0; k < 2; ++k)
+            {
+                memcpy(out_slack[k], slack, n * sizeof(int));
+                memcpy(out_nhbor[k], nhbor, n * sizeof(int));
+                memcpy(out_alpha[k], alphas, n * sizeof(int));
+                memcpy(out_beta[k], alphas, n * sizeof(int));
+                kernels[k]->update_slack(c, scale, alpha, beta, out_slack[k],
+                                         out_nhbor[k], z, n);
+                kernels[k]->update_duals(out_alpha[k], label, mate,
+                                         out_beta[k], slack, theta, n);
+            }
+
+            fail = fail
+                || kernels[0]->theta(slack, n) != kernels[1]->theta(slack, n)
+                || memcmp(out_slack[0], out_slack[1], n * sizeof(int))
+                || memcmp(out_nhbor[0], out_nhbor[1], n * sizeof(int))
+                || memcmp(out_alpha[0], out_alpha[1], n * sizeof(int))
+                || memcmp(out_beta[0], out_beta[1], n * sizeof(int));
+        }
+
+        num_fail += fail;
+    }
+
+    return num_fail;
+}
+
+// This function solves a batch of randomly sized problems, packed contiguously,
+// with the batched front end and again one at a time with the Jonker-Volgenant
+// engine. It returns the number of problems whose costs disagree.
+static int test_batch(void)
+{
+    int k, num_fail = 0;
+    int n[BATCH_SIZE];
+    int jv_mate[2 * BATCH_MAX_DIM];
+    int *c, *mate, *pc, *pm;
+    size_t total_c = 0, total_mate = 0;
+    for (k = 0; k < BATCH_SIZE; ++k)
+    {
+        n[k] = rand() % BATCH_MAX_DIM + 1;
+        total_c += n[k] * n[k];
+        total_mate += 2 * n[k];
+    }
+
+    c = (int *)malloc(total_c * sizeof(*c));
+    mate = (int *)malloc(total_mate * sizeof(*mate));
+    if (!c || !mate)
+    {
+        free(c);
+        free(mate);
+        return BATCH_SIZE;
+    }
+
+    for (k = 0, pc = c; k < BATCH_SIZE; pc += n[k] * n[k], ++k)
+    {
+        fill_randomly(pc, n[k]);
+    }
+
+    if (!hungarian_method_batch_packed(BATCH_SIZE, mate, c, n, BATCH_THREADS))
+    {
+        free(c);
+        free(mate);
+        return BATCH_SIZE;
+    }
+
+    for (k = 0, pc = c, pm = mate; k < BATCH_SIZE; ++k)
+    {
+        jonker_volgenant(jv_mate, pc, n[k]);
+        if (compute_cost(pm, pc, n[k]) != compute_cost(jv_mate, pc, n[k]))
+        {
+            ++num_fail;
+        }
+
+        pc += n[k] * n[k];
+        pm += 2 * n[k];
+    }
+
+    free(c);
+    free(mate);
+    return num_fail;
+}
+
+// This function solves randomly shaped rectangular problems with the
+// Jonker-Volgenant engine and compares each cost against the Hungarian method
+// on the same problem padded to a square with zero costs. It returns the number
+// of problems whose costs disagree.
+static int test_rectangular(void)
+{
+    int test, i, j, n, m, k, num_fail = 0;
+    int c[RECT_MAX_DIM * RECT_MAX_DIM];
+    int padded[RECT_MAX_DIM * RECT_MAX_DIM];
+    int mate[2 * RECT_MAX_DIM];
+    int rect_cost, padded_cost;
+    for (test = 1; test <= NUM_RECT_TESTS; ++test)
+    {
+        n = rand() % RECT_MAX_DIM + 1;
+        m = rand() % RECT_MAX_DIM + 1;
+        k = n > m ? n : m;
+        memset(padded, 0, k * k * sizeof(*padded));
+        for (i = 0; i < n; ++i)
+        {
+            for (j = 0; j < m; ++j)
+            {
+                padded[i * k + j] = c[i * m + j] = rand() % MAX_COST + 1;
+            }
+        }
+
+        jonker_volgenant(mate, c, n, m);
+        for (rect_cost = 0, i = 0; i < n; ++i)
+        {
+            rect_cost += mate[i] < 0 ? 0 : c[i * m + mate[i] - n];
+        }
+
+        hungarian_method(mate, padded, k);
+        padded_cost = compute_cost(mate, padded, k);
+        if (rect_cost != padded_cost)
+        {
+            ++num_fail;
+        }
+    }
+
+    return num_fail;
+}
+
+// This function solves random incomplete bipartite graphs with the sparse engine
+// and compares each against the Jonker-Volgenant engine on the dense matrix in
+// which every missing edge costs more than any matching of real edges. Such a
+// matching exists exactly when the dense optimum avoids missing edges. It
+// returns the number of problems on which the engines disagree.
+static int test_sparse(void)
+{
+    int test, i, j, n, m, e, num_fail = 0;
+    const int missing = RECT_MAX_DIM * MAX_COST + 1;
+    int c[RECT_MAX_DIM * RECT_MAX_DIM];
+    int row_start[RECT_MAX_DIM + 1];
+    int col[RECT_MAX_DIM * RECT_MAX_DIM];
+    int cost[RECT_MAX_DIM * RECT_MAX_DIM];
+    int mate[2 * RECT_MAX_DIM];
+    int sparse_cost, dense_cost;
+    bool feasible;
+    for (test = 1; test <= NUM_SPARSE_TESTS; ++test)
+    {
+        n = rand() % RECT_MAX_DIM + 1;
+        m = n + rand() % (RECT_MAX_DIM - n + 1);
+        for (e = 0, i = 0; i < n; ++i)
+        {
+            row_start[i] = e;
+            for (j = 0; j < m; ++j)
+            {
+                c[i * m + j] = missing;
+                if (rand() % 100 < SPARSE_DENSITY)
+                {
+                    c[i * m + j] = cost[e] = rand() % MAX_COST + 1;
+                    col[e++] = j;
+                }
+            }
+        }
+
+        row_start[n] = e;
+        feasible = sparse_assignment(mate, row_start, col, cost, n, m);
+        for (sparse_cost = 0, i = 0; feasible && i < n; ++i)
+        {
+            sparse_cost += c[i * m + mate[i] - n];
+        }
+
+        jonker_volgenant(mate, c, n, m);
+        for (dense_cost = 0, i = 0; i < n; ++i)
+        {
+            dense_cost += c[i * m + mate[i] - n];
+        }
+
+        if (feasible != (dense_cost < missing) ||
+            (feasible && sparse_cost != dense_cost))
+        {
+            ++num_fail;
+        }
+    }
+
+    return num_fail;
+}
+
+// This function solves random problems, changes a few costs of each, and warm
+// starts from the previous solution. Each warm-started matching is compared
+// against the Jonker-Volgenant engine, and its duals are checked to be feasible
+// and to sum to the matching's cost. It returns the number of problems that
+// fail any check.
+static int test_warm_start(void)
+{
+    int test, i, j, k, n, num_fail = 0;
+    int c[RECT_MAX_DIM * RECT_MAX_DIM];
+    int mate[2 * RECT_MAX_DIM];
+    int alpha[RECT_MAX_DIM], beta[RECT_MAX_DIM];
+    int warm_cost, jv_cost, dual_sum;
+    bool feasible;
+    for (test = 1; test <= NUM_WARM_TESTS; ++test)
+    {
+        n = rand() % RECT_MAX_DIM + 1;
+        fill_randomly(c, n);
+
+        // A warm start from nothing is a cold start.
+        for (i = 0; i < n; ++i)
+        {
+            mate[i] = mate[n + i] = -1;
+            alpha[i] = beta[i] = 0;
+        }
+
+        hungarian_method_warm(mate, alpha, beta, c, n);
+        for (k = 0; k < WARM_CHANGES; ++k)
+        {
+            c[rand() % (n * n)] = rand() % MAX_COST + 1;
+        }
+
+        hungarian_method_warm(mate, alpha, beta, c, n);
+        warm_cost = compute_cost(mate, c, n);
+        for (dual_sum = 0, feasible = true, i = 0; i < n; ++i)
+        {
+            dual_sum += alpha[i] + beta[i];
+            for (j = 0; j < n; ++j)
+            {
+                feasible = feasible && alpha[i] + beta[j] <= c[i * n + j];
+            }
+        }
+
+        jonker_volgenant(mate, c, n);
+        jv_cost = compute_cost(mate, c, n);
+        if (warm_cost != jv_cost || dual_sum != warm_cost || !feasible)
+        {
+            ++num_fail;
+        }
+    }
+
+    return num_fail;
+}
+
+// This function applies random sequences of row and column updates, additions,
+// and removals to dynamic solvers, mirroring each change on a copy of the
+// costs. After every change, the solver's matching is compared against the
+// Jonker-Volgenant engine on the copy. Costs too large to double are offered
+// every tenth change, and must be rejected without changing the problem. It
+// returns the number of changes after which the costs disagree.
+static int test_dynamic(void)
+{
+    int test, op, i, j, k, x, y, n, num_fail = 0;
+    int c[RECT_MAX_DIM * RECT_MAX_DIM], next[RECT_MAX_DIM * RECT_MAX_DIM];
+    int row[RECT_MAX_DIM + 1], col[RECT_MAX_DIM + 1];
+    int mate[2 * RECT_MAX_DIM];
+    c[0] = INT_MIN / 2;
+    if (hm_dynamic_create(c, 1, 1))
+    {
+        ++num_fail;
+    }
+
+    for (test = 1; test <= NUM_DYNAMIC_TESTS; ++test)
+    {
+        n = rand() % RECT_MAX_DIM + 1;
+        fill_randomly(c, n);
+        hm_dynamic<int> *d = hm_dynamic_create(c, n, RECT_MAX_DIM);
+        for (op = 1; op <= DYNAMIC_OPS; ++op)
+        {
+            for (i = 0; i <= n; ++i)
+            {
+                row[i] = rand() % MAX_COST + 1;
+                col[i] = rand() % MAX_COST + 1;
+            }
+
+            switch (rand() % 4)
+            {
+            case 0:
+                i = rand() % n;
+                hm_dynamic_update_row(d, i, row);
+                memcpy(&c[i * n], row, n * sizeof(*c));
+                break;
+
+            case 1:
+                j = rand() % n;
+                hm_dynamic_update_col(d, j, col);
+                for (i = 0; i < n; ++i)
+                {
+                    c[i * n + j] = col[i];
+                }
+
+                break;
+
+            case 2:
+                if (!hm_dynamic_add(d, row, col))
+                {
+                    continue;
+                }
+
+                for (i = 0; i < n; ++i)
+                {
+                    memcpy(&next[i * (n + 1)], &c[i * n], n * sizeof(*c));
+                    next[i * (n + 1) + n] = col[i];
+                }
+
+                memcpy(&next[n * (n + 1)], row, (n + 1) * sizeof(*c));
+                ++n;
+                memcpy(c, next, n * n * sizeof(*c));
+                break;
+
+            default:
+                if (n == 1)
+                {
+                    continue;
+                }
+
+                // Remove a row with its own column half of the time.
+                i = rand() % n;
+                j = rand() % 2 ? hm_dynamic_mate(d)[i] - n : rand() % n;
+                hm_dynamic_remove(d, i, j);
+                for (x = 0, k = 0; x < n; ++x)
+                {
+                    for (y = 0; y < n; ++y)
+                    {
+                        if (x != i && y != j)
+                        {
+                            next[k++] = c[x * n + y];
+                        }
+                    }
+                }
+
+                --n;
+                memcpy(c, next, n * n * sizeof(*c));
+                break;
+            }
+
+            jonker_volgenant(mate, c, n);
+            if (hm_dynamic_n(d) != n ||
+                compute_cost((int *)hm_dynamic_mate(d), c, n) !=
+                    compute_cost(mate, c, n))
+            {
+                ++num_fail;
+            }
+
+            if (op % 10 == 0)
+            {
+                row[rand() % n] = rand() % 2 ? INT_MAX / 2 + 1 : INT_MIN / 2;
+                if (hm_dynamic_update_row(d, rand() % n, row))
+                {
+                    ++num_fail;
+                }
+            }
+        }
+
+        hm_dynamic_free(d);
+    }
+
+    return num_fail;
+}
+
+// This function solves random problems with the parallel auction engine and
+// compares each cost against the Hungarian method, both as hungarian_method()
+// solves and by the stages of Figure 11-2. It returns the number of problems
+// whose costs disagree, all of them if the workspace could not be created.
+static int test_auction(void)
+{
+    int test, n, num_fail = 0;
+    int c[RECT_MAX_DIM * RECT_MAX_DIM];
+    int mate[2 * RECT_MAX_DIM];
+    int auction_cost, hm_cost;
+    hm_workspace *ws = hm_workspace_create(RECT_MAX_DIM);
+    if (!ws)
+    {
+        return NUM_AUCTION_TESTS;
+    }
+
+    for (test = 1; test <= NUM_AUCTION_TESTS; ++test)
+    {
+        n = rand() % RECT_MAX_DIM + 1;
+        fill_randomly(c, n);
+        auction_assignment(mate, c, n, BATCH_THREADS);
+        auction_cost = compute_cost(mate, c, n);
+        hungarian_method(ws, mate, c, n);
+        hm_cost = compute_cost(mate, c, n);
+        solve_by_stages(ws, mate, c, n);
+        if (auction_cost != hm_cost || auction_cost != compute_cost(mate, c, n))
+        {
+            ++num_fail;
+        }
+    }
+
+    hm_workspace_free(ws);
+    return num_fail;
+}
+
+// This function solves random problems with a workspace that runs every phase
+// of the Hungarian method on a pool of threads, scanning the costs column by
+// column rather than by the default row-wise pass, on int and double costs, and
+// compares each cost against the Jonker-Volgenant engine. It returns the number
+// of problems on which either cost disagrees, all of them if the workspace
+// could not be created.
+static int test_parallel(void)
+{
+    int test, n, num_fail = 0;
+    int c[RECT_MAX_DIM * RECT_MAX_DIM];
+    double d[RECT_MAX_DIM * RECT_MAX_DIM];
+    int mate[2 * RECT_MAX_DIM];
+    int hm_cost, hd_cost;
+    hm_options options;
+    hm_options_init(&options);
+    options.num_threads = BATCH_THREADS;
+    options.parallel_threshold = 1;
+    options.scan = hm_scan_columns;
+    hm_workspace *ws = hm_workspace_create(RECT_MAX_DIM, &options);
+    if (!ws)
+    {
+        return NUM_PARALLEL_TESTS;
+    }
+
+    for (test = 1; test <= NUM_PARALLEL_TESTS; ++test)
+    {
+        n = rand() % RECT_MAX_DIM + 1;
+        fill_randomly(c, n);
+        hungarian_method(ws, mate, c, n);
+        hm_cost = compute_cost(mate, c, n);
+        copy_to_double(d, c, n);
+        hungarian_method(ws, mate, d, n);
+        hd_cost = compute_cost(mate, c, n);
+        jonker_volgenant(mate, c, n);
+        if (hm_cost != compute_cost(mate, c, n) || hd_cost != hm_cost)
+        {
+            ++num_fail;
+        }
+    }
+
+    hm_workspace_free(ws);
+    return num_fail;
+}
+
+// This function solves random problems whose costs span most of the range of
+// int32_t, beyond what the solver can double in 32 bits, in the wide mode, and
+// compares each cost against the solver on the same costs as int64_t. It
+// returns the number of problems whose costs disagree.
+static int test_wide(void)
+{
+    int test, i, n, num_fail = 0;
+    int32_t c[RECT_MAX_DIM * RECT_MAX_DIM];
+    int64_t c64[RECT_MAX_DIM * RECT_MAX_DIM];
+    int mate[2 * RECT_MAX_DIM];
+    int64_t wide_cost, c64_cost;
+    for (test = 1; test <= NUM_WIDE_TESTS; ++test)
+    {
+        n = rand() % RECT_MAX_DIM + 1;
+        for (i = 0; i < n * n; ++i)
+        {
+            c64[i] = c[i] = (int32_t)((rand() % 2 ? 1 : -1) *
+                                      (2000000000 - rand() % MAX_COST));
+        }
+
+        hungarian_method_wide(mate, c, n);
+        for (wide_cost = 0, i = 0; i < n; ++i)
+        {
+            wide_cost += c64[i * n + mate[i] - n];
+        }
+
+        hungarian_method(mate, c64, n);
+        for (c64_cost = 0, i = 0; i < n; ++i)
+        {
+            c64_cost += c64[i * n + mate[i] - n];
+        }
+
+        if (wide_cost != c64_cost)
+        {
+            ++num_fail;
+        }
+    }
+
+    return num_fail;
+}
+
+// This function solves random problems for a matching of maximum cost, and
+// compares each cost against the Jonker-Volgenant engine minimizing a negated
+// copy of the costs. It returns the number of problems whose costs disagree.
+static int test_maximize(void)
+{
+    int test, i, n, num_fail = 0;
+    int c[RECT_MAX_DIM * RECT_MAX_DIM], negated[RECT_MAX_DIM * RECT_MAX_DIM];
+    int mate[2 * RECT_MAX_DIM];
+    int hm_cost;
+    hm_workspace *ws = hm_workspace_create(RECT_MAX_DIM);
+    if (!ws)
+    {
+        return NUM_MAXIMIZE_TESTS;
+    }
+
+    for (test = 1; test <= NUM_MAXIMIZE_TESTS; ++test)
+    {
+        n = rand() % RECT_MAX_DIM + 1;
+        fill_randomly(c, n);
+        for (i = 0; i < n * n; ++i)
+        {
+            negated[i] = -c[i];
+        }
+
+        hungarian_method(ws, mate, c, n, hm_maximize);
+        hm_cost = compute_cost(mate, c, n);
+        jonker_volgenant(mate, negated, n);
+        if (hm_cost != compute_cost(mate, c, n))
+        {
+            ++num_fail;
+        }
+    }
+
+    hm_workspace_free(ws);
+    return num_fail;
+}
+
+// Reads the costs of an n*n matrix on demand, for test_oracle().
+struct matrix_oracle
+{
+    const int *c;
+    int n;
+
+    int operator()(int i, int j) const
+    {
+        return c[i * n + j];
+    }
+};
+
+// Solves random problems through a cost functor, with the row cache disabled,
+// smaller than the matrix, and holding all of it, and compares each result
+// with that of jonker_volgenant(). Returns the number of failed problems.
+static int test_oracle(void)
+{
+    int test, n, cache_rows, num_fail = 0;
+    int c[RECT_MAX_DIM * RECT_MAX_DIM];
+    int mate[2 * RECT_MAX_DIM];
+    int jv_cost;
+    matrix_oracle oracle;
+
+    for (test = 1; test <= NUM_ORACLE_TESTS; ++test)
+    {
+        n = rand() % RECT_MAX_DIM + 1;
+        fill_randomly(c, n);
+        jonker_volgenant(mate, c, n);
+        jv_cost = compute_cost(mate, c, n);
+
+        oracle.c = c;
+        oracle.n = n;
+        switch (test % 3)
+        {
+        case 0: cache_rows = 0; break;
+        case 1: cache_rows = rand() % n + 1; break;
+        default: cache_rows = n; break;
+        }
+
+        if (!hm_oracle_solve(mate, oracle, n, cache_rows)
+            || jv_cost != compute_cost(mate, c, n))
+        {
+            ++num_fail;
+        }
+    }
+
+    return num_fail;
+}
+
+// Writes random problems to a cost file, solves each from the file's mapping,
+// and compares the result with that of solving from memory. Also checks that a
+// file whose header is truncated is rejected. Returns the number of failed
+// problems.
+static int test_cost_file(void)
+{
+    int test, n, num_fail = 0;
+    int c[RECT_MAX_DIM * RECT_MAX_DIM];
+    int mate[2 * RECT_MAX_DIM];
+    int hm_cost;
+    hm_cost_file *f;
+    hm_workspace *ws = hm_workspace_create(RECT_MAX_DIM);
+    if (!ws)
+    {
+        return NUM_FILE_TESTS;
+    }
+
+    for (test = 1; test <= NUM_FILE_TESTS; ++test)
+    {
+        n = rand() % RECT_MAX_DIM + 1;
+        fill_randomly(c, n);
+        hungarian_method(ws, mate, c, n);
+        hm_cost = compute_cost(mate, c, n);
+
+        if (!hm_cost_file_write(FILE_PATH, hm_dtype_int32, c, n)
+            || !(f = hm_cost_file_open(FILE_PATH)))
+        {
+            ++num_fail;
+            continue;
+        }
+
+        if (hm_cost_file_n(f) != n || hm_cost_file_dtype(f) != hm_dtype_int32
+            || !hm_cost_file_solve(ws, mate, f)
+            || hm_cost != compute_cost(mate, c, n))
+        {
+            ++num_fail;
+        }
+
+        hm_cost_file_close(f);
+    }
+
+    // A file of costs with no header.
+    FILE *fp = fopen(FILE_PATH, "wb");
+    if (fp)
+    {
+        fwrite(c, sizeof(*c), 16, fp);
+        fclose(fp);
+        if ((f = hm_cost_file_open(FILE_PATH)))
+        {
+            ++num_fail;
+            hm_cost_file_close(f);
+        }
+    }
+
+    remove(FILE_PATH);
+    hm_workspace_free(ws);
+    return num_fail;
+}
+
+// Enumerates the k least costly assignments of random problems and compares
+// their costs with those of every permutation, sorted. Also checks that no
+// assignment is reported twice. Returns the number of failed problems.
+static int test_ranked(void)
+{
+    int test, i, k, r, n, count, num_perms, fail, num_fail = 0;
+    int c[RANKED_MAX_DIM * RANKED_MAX_DIM], perm[RANKED_MAX_DIM];
+    int mates[RANKED_K * 2 * RANKED_MAX_DIM];
+    int64_t costs[RANKED_K], all[720];
+
+    for (test = 1; test <= NUM_RANKED_TESTS; ++test)
+    {
+        n = rand() % RANKED_MAX_DIM + 1;
+        fill_randomly(c, n);
+
+        num_perms = 0;
+        for (i = 0; i < n; ++i)
+        {
+            perm[i] = i;
+        }
+
+        do
+        {
+            all[num_perms] = 0;
+            for (i = 0; i < n; ++i)
+            {
+                all[num_perms] += c[i * n + perm[i]];
+            }
+
+            ++num_perms;
+        } while (std::next_permutation(perm, perm + n));
+
+        std::sort(all, all + num_perms);
+        count = k_best_assignments(mates, costs, c, n, RANKED_K);
+        fail = count != std::min(num_perms, RANKED_K);
+        for (k = 0; k < count && !fail; ++k)
+        {
+            fail = costs[k] != all[k]
+                || costs[k] != compute_cost(mates + k * 2 * n, c, n);
+            for (r = 0; r < k && !fail; ++r)
+            {
+                fail = !memcmp(mates + k * 2 * n, mates + r * 2 * n,
+                               2 * n * sizeof(int));
+            }
+        }
+
+        num_fail += fail;
+    }
+
+    return num_fail;
+}
+
+// Solves random problems larger than TEST_DIM with the brute-force search on
+// several threads, and compares each result with that of jonker_volgenant().
+// Returns the number of failed problems.
+static int test_brute_force(void)
+{
+    int test, n, num_fail = 0;
+    int c[BRUTE_MAX_DIM * BRUTE_MAX_DIM];
+    int mate[2 * BRUTE_MAX_DIM];
+    int jv_cost;
+
+    for (test = 1; test <= NUM_BRUTE_TESTS; ++test)
+    {
+        n = rand() % BRUTE_MAX_DIM + 1;
+        fill_randomly(c, n);
+        jonker_volgenant(mate, c, n);
+        jv_cost = compute_cost(mate, c, n);
+        if (!brute_force_assignment(mate, c, n, BATCH_THREADS)
+            || jv_cost != compute_cost(mate, c, n))
+        {
+            ++num_fail;
+        }
+    }
+
+    return num_fail;
+}
+
+// Solves random problems in the bounded mode: within a budget of the optimal
+// cost, one less, a stage limit, and a time limit already passed. Checks each
+// status, that every bound is at most the optimal cost and, given a budget one
+// less, exactly it, and that a stage limit of k leaves k edges matched. Bounds
+// beyond the range of int, above and below, must be clamped and reported
+// respectively. Returns the number of failed problems.
+static int test_bounded(void)
+{
+    int test, n, i, k, matched, num_fail = 0;
+    int c[RECT_MAX_DIM * RECT_MAX_DIM];
+    int mate[2 * RECT_MAX_DIM];
+    int opt, bound, status;
+    bool fail;
+    hm_limits limits;
+    hm_workspace *ws = hm_workspace_create(RECT_MAX_DIM);
+    if (!ws)
+    {
+        return NUM_BOUNDED_TESTS;
+    }
+
+    for (i = 0; i < 9; ++i)
+    {
+        c[i] = INT_MAX / 2;
+    }
+
+    fail = hungarian_method_bounded(ws, mate, c, 3, INT_MAX, NULL, &bound)
+            != hm_status_over_budget
+        || bound != INT_MAX;
+    for (i = 0, bound = 0; i < 9; ++i)
+    {
+        c[i] = -(INT_MAX / 2);
+    }
+
+    fail = fail
+        || hungarian_method_bounded(ws, mate, c, 3, INT_MAX, NULL, &bound)
+            != hm_status_out_of_range
+        || bound != 0;
+    num_fail += fail;
+
+    for (test = 1; test <= NUM_BOUNDED_TESTS; ++test)
+    {
+        n = rand() % RECT_MAX_DIM + 1;
+        fill_randomly(c, n);
+        jonker_volgenant(mate, c, n);
+        opt = compute_cost(mate, c, n);
+
+        status = hungarian_method_bounded(ws, mate, c, n, opt, NULL, &bound);
+        fail = status != hm_status_optimal || bound != opt
+            || compute_cost(mate, c, n) != opt;
+
+        status = hungarian_method_bounded(ws, mate, c, n, opt - 1, NULL,
+                                          &bound);
+        fail = fail || status != hm_status_over_budget || bound != opt;
+
+        hm_limits_init(&limits);
+        limits.max_stages = k = n > 1 ? rand() % (n - 1) + 1 : 1;
+        status = hungarian_method_bounded(ws, mate, c, n, MAX_COST * n,
+                                          &limits, &bound);
+        for (i = 0, matched = 0; i < n; ++i)
+        {
+            if (mate[i] >= 0)
+            {
+                fail = fail || mate[mate[i]] != i;
+                ++matched;
+            }
+        }
+
+        fail = fail || bound > opt
+            || (n > 1 ? status != hm_status_stage_limit || matched != k
+                      : status != hm_status_optimal);
+
+        hm_limits_init(&limits);
+        limits.seconds = 1e-12;
+        status = hungarian_method_bounded(ws, mate, c, n, MAX_COST * n,
+                                          &limits, &bound);
+        fail = fail || status != hm_status_time_limit || bound > opt;
+        num_fail += fail;
+    }
+
+    hm_workspace_free(ws);
+    return num_fail;
+}
+
+// Solves random problems small enough for the fixed-size solver, on int and
+// double costs, and compares each cost against the general solver, which
+// hungarian_method_bounded() always runs. Returns the number of failed
+// problems.
+static int test_fixed(void)
+{
+    int test, n, num_fail = 0;
+    int c[FIXED_MAX_DIM * FIXED_MAX_DIM];
+    double d[FIXED_MAX_DIM * FIXED_MAX_DIM];
+    int mate[2 * FIXED_MAX_DIM];
+    int hm_cost, hd_cost, bound;
+    hm_workspace *ws = hm_workspace_create(FIXED_MAX_DIM);
+    if (!ws)
+    {
+        return NUM_FIXED_TESTS;
+    }
+
+    for (test = 1; test <= NUM_FIXED_TESTS; ++test)
+    {
+        n = test % FIXED_MAX_DIM + 1;
+        fill_randomly(c, n);
+        hungarian_method(ws, mate, c, n);
+        hm_cost = compute_cost(mate, c, n);
+        copy_to_double(d, c, n);
+        hungarian_method(ws, mate, d, n);
+        hd_cost = compute_cost(mate, c, n);
+        hungarian_method_bounded(ws, mate, c, n, MAX_COST * n, NULL, &bound);
+        if (hm_cost != bound || hd_cost != bound
+            || compute_cost(mate, c, n) != bound)
+        {
+            ++num_fail;
+        }
+    }
+
+    hm_workspace_free(ws);
+    return num_fail;
+}
+
+// Counts the violations of the duals alpha and beta of a solution to the n*n
+// costs c with the matching mate: of alpha[i] + beta[j] <= c[i][j] when
+// minimizing, or >= when maximizing, and of equality on the matching.
+static int count_dual_violations(int *mate, int *alpha, int *beta, int *c,
+                                 int n, int sense)
+{
+    int i, j, d, count = 0;
+    for (i = 0; i < n; ++i)
+    {
+        for (j = 0; j < n; ++j)
+        {
+            d = c[i * n + j] - alpha[i] - beta[j];
+            if ((sense == hm_minimize ? d < 0 : d > 0)
+                || (mate[i] == n + j && d != 0))
+            {
+                ++count;
+            }
+        }
+    }
+
+    return count;
+}
+
+// Solves random problems of sizes on either side of the fixed-size solver's
+// limit, in both senses, asking for the cost and duals. Checks the cost against
+// compute_cost() and hungarian_method(), and the duals with
+// count_dual_violations(). Costs summing beyond the range of int, in both
+// solvers, must be reported as such. Returns the number of failed problems.
+static int test_solution(void)
+{
+    int test, n, k, sense, num_fail = 0;
+    int c[RECT_MAX_DIM * RECT_MAX_DIM];
+    int mate[2 * RECT_MAX_DIM];
+    int alpha[RECT_MAX_DIM], beta[RECT_MAX_DIM];
+    hm_solution<int> solution;
+    hm_workspace *ws = hm_workspace_create(RECT_MAX_DIM);
+    if (!ws)
+    {
+        return NUM_SOLUTION_TESTS;
+    }
+
+    solution.alpha = alpha;
+    solution.beta = beta;
+    for (k = 0; k < RECT_MAX_DIM * RECT_MAX_DIM; ++k)
+    {
+        c[k] = INT_MAX / 2;
+    }
+
+    for (n = 3; n <= RECT_MAX_DIM; n += RECT_MAX_DIM - 3)
+    {
+        hungarian_method(ws, mate, c, n, hm_minimize, &solution);
+        num_fail += solution.cost_fits;
+    }
+
+    for (test = 1; test <= NUM_SOLUTION_TESTS; ++test)
+    {
+        n = rand() % RECT_MAX_DIM + 1;
+        sense = test % 2 ? hm_minimize : hm_maximize;
+        fill_randomly(c, n);
+        hungarian_method(ws, mate, c, n, sense, &solution);
+        if (!solution.cost_fits || solution.cost != compute_cost(mate, c, n)
+            || count_dual_violations(mate, alpha, beta, c, n, sense))
+        {
+            ++num_fail;
+            continue;
+        }
+
+        hungarian_method(ws, mate, c, n, sense);
+        if (solution.cost != compute_cost(mate, c, n))
+        {
+            ++num_fail;
+        }
+    }
+
+    hm_workspace_free(ws);
+    return num_fail;
+}
+
+// Solves random problems through the C interface, with a solver created for
+// smaller problems so that it must grow. Checks each cost against
+// jonker_volgenant() and the duals for feasibility and tightness on the mate,
+// then solves a packed batch of problems. A cost beyond the range of int must
+// be reported rather than returned. Returns the number of failed problems, all
+// of them if the solver could not be created.
+static int test_capi(void)
+{
+    int test, n, k, num_fail = 0;
+    int c[CAPI_BATCH * RECT_MAX_DIM * RECT_MAX_DIM];
+    int mate[CAPI_BATCH * 2 * RECT_MAX_DIM];
+    int sizes[CAPI_BATCH];
+    int alpha[RECT_MAX_DIM], beta[RECT_MAX_DIM];
+    int cost, offset, mate_offset;
+    bool fail;
+    hm_solver *s;
+    if (hm_solver_create(HM_CAPI_VERSION + 1, 1, 1, &s)
+            != hm_capi_version_mismatch
+        || hm_solver_create(HM_CAPI_VERSION, 1, BATCH_THREADS, &s)
+            != hm_capi_ok)
+    {
+        return NUM_CAPI_TESTS;
+    }
+
+    for (k = 0; k < 9; ++k)
+    {
+        c[k] = INT_MAX / 2;
+    }
+
+    fail = hm_solver_cost(s, &cost) != hm_capi_no_solution
+        || hm_solver_solve(s, 0, c, 1, hm_capi_minimize, mate)
+            != hm_capi_invalid_argument
+        || hm_solver_solve(s, hm_capi_int32, c, 3, hm_capi_minimize, mate)
+            != hm_capi_ok
+        || hm_solver_cost(s, &cost) != hm_capi_out_of_range;
+    num_fail += fail;
+    for (test = 2; test <= NUM_CAPI_TESTS; ++test)
+    {
+        n = rand() % RECT_MAX_DIM + 1;
+        fill_randomly(c, n);
+        fail = hm_solver_solve(s, hm_capi_int32, c, n, hm_capi_minimize, mate)
+                != hm_capi_ok
+            || hm_solver_cost(s, &cost) != hm_capi_ok
+            || hm_solver_duals(s, alpha, beta) != hm_capi_ok
+            || cost != compute_cost(mate, c, n)
+            || count_dual_violations(mate, alpha, beta, c, n, hm_minimize);
+        jonker_volgenant(mate, c, n);
+        fail = fail || cost != compute_cost(mate, c, n);
+
+        // A batch of problems, packed one after another.
+        for (k = 0, offset = 0; k < CAPI_BATCH; ++k)
+        {
+            sizes[k] = rand() % RECT_MAX_DIM + 1;
+            fill_randomly(c + offset, sizes[k]);
+            offset += sizes[k] * sizes[k];
+        }
+
+        fail = fail || hm_solver_solve_batch(s, hm_capi_int32, CAPI_BATCH, c,
+                                             sizes, mate) != hm_capi_ok
+            || hm_solver_cost(s, &cost) != hm_capi_no_solution;
+        for (k = 0, offset = 0, mate_offset = 0; k < CAPI_BATCH; ++k)
+        {
+            cost = compute_cost(mate + mate_offset, c + offset, sizes[k]);
+            jonker_volgenant(mate + mate_offset, c + offset, sizes[k]);
+            fail = fail
+                || cost != compute_cost(mate + mate_offset, c + offset,
+                                        sizes[k]);
+            offset += sizes[k] * sizes[k];
+            mate_offset += 2 * sizes[k];
+        }
+        num_fail += fail;
+    }
+
+    hm_solver_destroy(s);
+    return num_fail;
+}
+
+// Counts the completions of service requests, through their contexts.
+static void count_completion(hm_request *r)
+{
+    ++*(std::atomic<int> *)r->context;
+}
+
+// Submits random problems to a service with a queue too small to hold them
+// all, retrying those it rejects, and waits on each. Checks each cost against
+// jonker_volgenant() and that every request was completed once. Returns the
+// number of failed problems, all of them if the service could not be created.
+static int test_service(void)
+{
+    int test, oldest = 0, num_fail = 0;
+    std::atomic<int> completions(0);
+    hm_service_options options;
+    hm_service_options_init(&options);
+    options.num_threads = BATCH_THREADS;
+    options.queue_capacity = SERVICE_QUEUE;
+    hm_service *s = hm_service_create(&options);
+    int *c = (int *)malloc(NUM_SERVICE_TESTS * RECT_MAX_DIM * RECT_MAX_DIM
+                           * sizeof(int));
+    int *mate = (int *)malloc(NUM_SERVICE_TESTS * 2 * RECT_MAX_DIM
+                              * sizeof(int));
+    hm_request *requests = new hm_request[NUM_SERVICE_TESTS];
+    if (!s || !c || !mate)
+    {
+        hm_service_free(s);
+        free(c);
+        free(mate);
+        delete[] requests;
+        return NUM_SERVICE_TESTS;
+    }
+
+    for (test = 0; test < NUM_SERVICE_TESTS; ++test)
+    {
+        hm_request *r = &requests[test];
+        int *cost = c + test * RECT_MAX_DIM * RECT_MAX_DIM;
+        int n = rand() % RECT_MAX_DIM + 1;
+        fill_randomly(cost, n);
+        hm_request_init(r, cost, n, mate + test * 2 * RECT_MAX_DIM);
+        r->done = count_completion;
+        r->context = &completions;
+        while (!hm_service_submit(s, r))
+        {
+            // The queue is full: wait on the oldest request submitted.
+            if (oldest < test)
+            {
+                hm_service_wait(s, &requests[oldest++]);
+            }
+        }
+    }
+
+    for (test = 0; test < NUM_SERVICE_TESTS; ++test)
+    {
+        hm_request *r = &requests[test];
+        int *cost = c + test * RECT_MAX_DIM * RECT_MAX_DIM;
+        bool fail = hm_service_wait(s, r) != hm_request_done
+            || r->cost != compute_cost(r->mate, cost, r->n);
+        jonker_volgenant(r->mate, cost, r->n);
+        num_fail += fail || r->cost != compute_cost(r->mate, cost, r->n);
+    }
+
+    hm_service_free(s);
+    num_fail += completions.load() != NUM_SERVICE_TESTS;
+    free(c);
+    free(mate);
+    delete[] requests;
+    return std::min(num_fail, NUM_SERVICE_TESTS);
+}
+
+#ifdef HM_STATS
+// Checks the statistics of random solves for consistency: a solve from scratch
+// runs one stage per vertex, each applying one augmenting path of odd length.
+// Returns the number of failed problems.
+static int test_stats(void)
+{
+    int test, n, num_fail = 0;
+    int c[RECT_MAX_DIM * RECT_MAX_DIM];
+    int mate[2 * RECT_MAX_DIM];
+    hm_workspace *ws = hm_workspace_create(RECT_MAX_DIM);
+    if (!ws)
+    {
+        return NUM_STATS_TESTS;
+    }
+
+    const hm_stats *stats = hm_workspace_stats(ws);
+    for (test = 1; test <= NUM_STATS_TESTS; ++test)
+    {
+        n = rand() % RECT_MAX_DIM + 1;
+        fill_randomly(c, n);
+        hungarian_method(ws, mate, c, n);
+        if (stats->stages != n || stats->augmentations != n
+            || stats->path_edges < n || stats->max_path_edges % 2 != 1
+            || stats->path_edges > n * stats->max_path_edges)
+        {
+            ++num_fail;
+        }
+    }
+
+    hm_workspace_free(ws);
+    return num_fail;
+}
+#endif
+
 // This is a convenience function for displaying the contents of the n*n cost
 // matrix c when tracing execution.
 void print_c(int *c, int n)
@@ -85,9 +1312,20 @@ int main(void)
                                    7, 9, 4, 2, 2, \
                                    8, 4, 7, 4, 8 };
 
+    double d[TEST_DIM * TEST_DIM];
     int mate[2 * TEST_DIM];
-    int bf_cost, hm_cost;
+    int bf_cost, hm_cost, hd_cost, ps_cost, psd_cost, jv_cost;
     int num_pass = 0;
+
+    // A single workspace is reused by every test, as an application solving
+    // many problems would do.
+    hm_workspace *ws = hm_workspace_create(TEST_DIM);
+    if (!ws)
+    {
+        printf("Failed to create workspace\n");
+        return 1;
+    }
+
     srand((unsigned)time(NULL));
     for (test = 1; test <= NUM_TESTS; ++test)
     {
@@ -101,11 +1339,30 @@ int main(void)
         bf_cost = compute_cost(mate, c, TEST_DIM);
 
         // Compute the cost via Hungarian method.
-        hungarian_method(mate, c, TEST_DIM);
+        hungarian_method(ws, mate, c, TEST_DIM);
         hm_cost = compute_cost(mate, c, TEST_DIM);
 
+        // Compute the cost via Hungarian method on the same costs as doubles.
+        copy_to_double(d, c, TEST_DIM);
+        hungarian_method(ws, mate, d, TEST_DIM);
+        hd_cost = compute_cost(mate, c, TEST_DIM);
+
+        // Compute both again by the stages of Figure 11-2, which TEST_DIM is
+        // small enough for hungarian_method() to bypass.
+        solve_by_stages(ws, mate, c, TEST_DIM);
+        ps_cost = compute_cost(mate, c, TEST_DIM);
+        solve_by_stages(ws, mate, d, TEST_DIM);
+        psd_cost = compute_cost(mate, c, TEST_DIM);
+
+        // Compute the cost via the shortest augmenting path engine.
+        jonker_volgenant(mate, c, TEST_DIM);
+        jv_cost = compute_cost(mate, c, TEST_DIM);
+
         // Check and display output.
-        if (bf_cost == hm_cost)
+        bool pass = bf_cost == hm_cost && bf_cost == hd_cost &&
+                    bf_cost == ps_cost && bf_cost == psd_cost &&
+                    bf_cost == jv_cost;
+        if (pass)
         {
             ++num_pass;
         }
@@ -113,12 +1370,60 @@ int main(void)
         printf(
             "Test %d: %s\n" \
             "         Brute Force = %10d\n" \
-            "    Hungarian Method = %10d\n",
+            "    Hungarian Method = %10d\n" \
+            "  ... (double costs) = %10d\n" \
+            "   ... (Figure 11-2) = %10d\n" \
+            " ... (11-2, doubles) = %10d\n" \
+            "    Jonker-Volgenant = %10d\n",
             test,
-            bf_cost == hm_cost ? "+++ Pass +++" : "--- Fail ---",
-            bf_cost, hm_cost);
+            pass ? "+++ Pass +++" : "--- Fail ---",
+            bf_cost, hm_cost, hd_cost, ps_cost, psd_cost, jv_cost);
     }
 
     printf("Number of tests passed = %d out of %d\n", num_pass, NUM_TESTS);
+    printf("Number of SIMD kernel tests passed = %d out of %d\n",
+           NUM_SIMD_TESTS - test_simd(), NUM_SIMD_TESTS);
+    printf("Number of batched problems passed = %d out of %d\n",
+           BATCH_SIZE - test_batch(), BATCH_SIZE);
+    printf("Number of rectangular tests passed = %d out of %d\n",
+           NUM_RECT_TESTS - test_rectangular(), NUM_RECT_TESTS);
+    printf("Number of sparse tests passed = %d out of %d\n",
+           NUM_SPARSE_TESTS - test_sparse(), NUM_SPARSE_TESTS);
+    printf("Number of warm-started tests passed = %d out of %d\n",
+           NUM_WARM_TESTS - test_warm_start(), NUM_WARM_TESTS);
+    printf("Number of dynamic changes passed = %d out of %d\n",
+           NUM_DYNAMIC_TESTS * DYNAMIC_OPS - test_dynamic(),
+           NUM_DYNAMIC_TESTS * DYNAMIC_OPS);
+    printf("Number of auction tests passed = %d out of %d\n",
+           NUM_AUCTION_TESTS - test_auction(), NUM_AUCTION_TESTS);
+    printf("Number of parallel tests passed = %d out of %d\n",
+           NUM_PARALLEL_TESTS - test_parallel(), NUM_PARALLEL_TESTS);
+    printf("Number of wide-mode tests passed = %d out of %d\n",
+           NUM_WIDE_TESTS - test_wide(), NUM_WIDE_TESTS);
+    printf("Number of maximization tests passed = %d out of %d\n",
+           NUM_MAXIMIZE_TESTS - test_maximize(), NUM_MAXIMIZE_TESTS);
+    printf("Number of cost oracle tests passed = %d out of %d\n",
+           NUM_ORACLE_TESTS - test_oracle(), NUM_ORACLE_TESTS);
+    printf("Number of cost file tests passed = %d out of %d\n",
+           NUM_FILE_TESTS - test_cost_file(), NUM_FILE_TESTS);
+    printf("Number of ranked assignment tests passed = %d out of %d\n",
+           NUM_RANKED_TESTS - test_ranked(), NUM_RANKED_TESTS);
+    printf("Number of brute-force tests passed = %d out of %d\n",
+           NUM_BRUTE_TESTS - test_brute_force(), NUM_BRUTE_TESTS);
+    printf("Number of bounded tests passed = %d out of %d\n",
+           NUM_BOUNDED_TESTS - test_bounded(), NUM_BOUNDED_TESTS);
+    printf("Number of fixed-size tests passed = %d out of %d\n",
+           NUM_FIXED_TESTS - test_fixed(), NUM_FIXED_TESTS);
+    printf("Number of solution tests passed = %d out of %d\n",
+           NUM_SOLUTION_TESTS - test_solution(), NUM_SOLUTION_TESTS);
+    printf("Number of C interface tests passed = %d out of %d\n",
+           NUM_CAPI_TESTS - test_capi(), NUM_CAPI_TESTS);
+    printf("Number of service tests passed = %d out of %d\n",
+           NUM_SERVICE_TESTS - test_service(), NUM_SERVICE_TESTS);
+#ifdef HM_STATS
+    printf("Number of statistics tests passed = %d out of %d\n",
+           NUM_STATS_TESTS - test_stats(), NUM_STATS_TESTS);
+#endif
+    hm_workspace_free(ws);
     return 0;
 }
@@ -20,8 +20,30 @@
 // November 2010.
 
 #include "hungarian_method.h"
+#include "hm_pool.h"
+#include "hm_simd.h"
 #include <cstdlib>
-#include <limits.h>
+#include <stdint.h>
+#include <chrono>
+#include <limits>
+#include <thread>
+#include <type_traits>
+
+#ifdef HM_STATS
+#include <cstring>
+#endif
+
+// The least n solved in parallel by a workspace with a pool, by default. See
+// hm_options_init().
+#ifndef HM_PARALLEL_THRESHOLD
+#define HM_PARALLEL_THRESHOLD 1024
+#endif
+
+// The largest n solved by the fixed-size solver rather than the general one, at
+// most 16, or zero to always run the general one. See hm_fixed_solve().
+#ifndef HM_FIXED_MAX_N
+#define HM_FIXED_MAX_N 16
+#endif
 
 // Solely for the tracing function hm_print() defined below.
 #include <cstdio>
@@ -38,30 +60,72 @@ enum
 // Convenience macros to reduce clutter, improve readability, and facilitate
 // translation of vertex labels to zero-based indices where needed. Primarily
 // assists with writing as closely as possible to the text's pseudocode.
+//
+// Note that C() doubles each cost as it is read, which ensures integrality of
+// the alphabeta algorithm (theta_one is halved in hm_modify()) without writing
+// to the caller's cost matrix. All duals and slacks are therefore doubled too.
+// When maximizing, C() also negates each cost, again without a copy of the
+// matrix; hm->scale holds the factor of 2 or -2 applied.
+//
+// Every function using these macros works on an hm_data whose costs are of type
+// T and whose duals and slacks are of type DUAL, which is T itself unless the
+// solver runs in its wide mode (see hm_data below). C() converts each cost to
+// DUAL before doubling it. INF is the "infinite" value of DUAL, and SNAP()
+// rounds a reduced cost to zero when it is within the solver's tolerance of
+// zero (see hm_cost_traits below).
 #define Q           (hm->q)
 #define A           (hm->a)
 #define N           (hm->n)
 #define V(i_)       (i_)
 #define U(j_)       ((j_) - N)
 #define MATE(i_)    (hm->mate[V(i_)])
-#define C(i_, j_)   (hm->c[V(i_) * N + U(j_)])
+#define DUAL        decltype(hm->eps)
+#define C(i_, j_)   (hm->scale * (DUAL)hm->c[V(i_) * N + U(j_)])
 #define ALPHA(i_)   (hm->alpha[V(i_)])
 #define BETA(j_)    (hm->beta[U(j_)])
 #define SLACK(j_)   (hm->slack[U(j_)])
 #define NHBOR(j_)   (hm->nhbor[U(j_)])
-#define COUNT(i_)   (hm->count[V(i_)])
 #define EXPOSED(i_) (hm->exposed[V(i_)])
 #define LABEL(i_)   (hm->label[V(i_)])
 #define EACH_V(i_)  (i_ = 0; i_ < N; ++i_)
 #define EACH_U(j_)  (j_ = N; j_ < 2 * N; ++j_)
+#define INF         (hm_cost_traits<DUAL>::infinity())
+#define SNAP(x_)    (hm_cost_traits<DUAL>::snap((x_), hm->eps))
+
+// Instrumentation, compiled in only when HM_STATS is defined, so that it costs
+// nothing otherwise. HM_COUNT() adds to a counter of hm->stats, and HM_TIME()
+// adds the time until the end of the enclosing block to one of its timings.
+#ifdef HM_STATS
+#define HM_COUNT(field_, x_) (hm->stats->field_ += (x_))
+#define HM_TIME(field_)      hm_timer hm_timer_(&hm->stats->field_)
+
+struct hm_timer
+{
+    double *total;
+    std::chrono::steady_clock::time_point start;
+
+    explicit hm_timer(double *t)
+        : total(t), start(std::chrono::steady_clock::now()) {}
+
+    ~hm_timer()
+    {
+        *total += std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+};
+#else
+#define HM_COUNT(field_, x_) ((void)0)
+#define HM_TIME(field_)      ((void)0)
+#endif
 
 // The basic data structures.
 typedef struct stack_    stack;
-typedef struct arc_      arc;
 typedef struct arc_list_ arc_list;
-typedef struct hm_data_  hm_data;
 
-// The data structure corresponding to Q (see Figure 11-2).
+// The data structure corresponding to Q (see Figure 11-2). Its capacity is 2n:
+// within a stage, each vertex of V is pushed at most once when it seeds the
+// search or becomes labeled, and hm_modify() pushes nhbor[u] at most once for
+// each u in U.
 struct stack_
 {
     int *data;
@@ -78,88 +142,274 @@ static int stack_pop(stack *s)
     return s->data[--s->size];
 }
 
-// The data structures corresponding to A (see Figure 11-2).
-struct arc_
+// The data structure corresponding to A (see Figure 11-2). Arcs are kept in
+// per-tail buckets so that the search sub-stage can visit the arcs leaving a
+// vertex without scanning all of A. The heads of the size[x] arcs with tail x
+// are data[x * stride], ..., data[x * stride + size[x] - 1].
+//
+// A bucket never holds more than n arcs: within a stage, construction adds at
+// most one arc (x,mate[u]) per u in U, and hm_modify() only adds (nhbor[u],
+// mate[u]) for a u whose edge to nhbor[u] was not already in the equality
+// subgraph when nhbor[u] was labeled.
+//
+// The n*n buckets are by far the largest part of the working set, so the heads,
+// which are vertices of V, are kept as 16-bit indices in narrow whenever n is at
+// most hm_narrow_max. This halves the buckets, keeping those of mid-size n in
+// cache. The branch between the two widths is the same for every arc of a
+// solve, so it costs next to nothing.
+enum
 {
-    int x;
-    int y;
+    hm_narrow_max = 65536
 };
 
 struct arc_list_
 {
-    arc *data;
-    int size;
+    int *data;        // the heads, unless narrow is set
+    uint16_t *narrow; // the heads as 16-bit indices, or NULL
+    int *size;
+    int stride;
 };
 
 static void add_arc(arc_list *a, int x, int y)
 {
-    arc *pa = a->data + a->size++;
-    pa->x = x;
-    pa->y = y;
+    int k = x * a->stride + a->size[x]++;
+    if (a->narrow)
+    {
+        a->narrow[k] = (uint16_t)y;
+    }
+    else
+    {
+        a->data[k] = y;
+    }
+}
+
+// Returns the head of the k-th arc with tail x.
+static int arc_head(const arc_list *a, int x, int k)
+{
+    return a->narrow ? a->narrow[x * a->stride + k] : a->data[x * a->stride + k];
 }
 
+// The cost type traits. Integer costs are compared exactly. Floating-point
+// costs are compared with a tolerance proportional to the largest (doubled)
+// cost magnitude and to n, so that rounding error accumulated by the dual
+// updates cannot hide an edge of the equality subgraph.
+template <typename T, bool = std::numeric_limits<T>::is_integer>
+struct hm_cost_traits;
+
+template <typename T>
+struct hm_cost_traits<T, true>
+{
+    static T infinity() { return std::numeric_limits<T>::max(); }
+    static T tolerance(T, int) { return 0; }
+    static T snap(T x, T) { return x; }
+
+    // Halve a doubled dual, rounding alpha down and beta up. If alpha + beta
+    // <= 2c, so is the sum of the halves <= c, and if the two are equal, so are
+    // the halves, as then alpha and beta are both odd or both even.
+    static T half_down(T x) { return x / 2 - (x % 2 < 0); }
+    static T half_up(T x) { return x / 2 + (x % 2 > 0); }
+
+    // Adds x to *sum, unless the result would overflow T, in which case this
+    // returns false, leaving *sum as it was.
+    static bool add(T *sum, T x)
+    {
+        if (x > 0 ? *sum > std::numeric_limits<T>::max() - x
+                  : *sum < std::numeric_limits<T>::lowest() - x)
+        {
+            return false;
+        }
+
+        *sum += x;
+        return true;
+    }
+};
+
+template <typename T>
+struct hm_cost_traits<T, false>
+{
+    static T infinity() { return std::numeric_limits<T>::infinity(); }
+
+    static T tolerance(T magnitude, int n)
+    {
+        return magnitude * n * std::numeric_limits<T>::epsilon();
+    }
+
+    static T snap(T x, T eps) { return -eps <= x && x <= eps ? 0 : x; }
+    static T half_down(T x) { return x / 2; }
+    static T half_up(T x) { return x / 2; }
+
+    static bool add(T *sum, T x)
+    {
+        *sum += x;
+        return true;
+    }
+};
+
+// The limits of a bounded solve. See hungarian_method_bounded().
+template <typename D>
+struct hm_bounds;
+
 // This structure type holds all data pertinent to P&S's Hungarian method. See
 // Figure 11-2.
-struct hm_data_
+//
+// The costs are of type T and the duals and slacks of type D. In the wide mode,
+// D is int64_t over int32_t costs, so that costs up to the full range of int32_t
+// can be doubled and summed into duals without overflow, while the cost matrix,
+// which dominates memory traffic, keeps its 32-bit storage.
+template <typename T, typename D = T>
+struct hm_data
 {
     // Allocated and/or defined by the caller of hungarian_method().
     int *mate;
-    int *c;
+    const T *c;
     int n;
 
-    // Allocated internally.
+    // Allocated internally, within the arena of an hm_workspace.
     stack q;
     arc_list a;
-    int *alpha;
-    int *beta;
-    int *slack;
+    D *alpha;
+    D *beta;
+    D *slack;
     int *nhbor;
-    int *count;
     int *exposed;
     int *label;
+
+    // The members of U that hm_modify() found tight, gathered chunk by chunk in
+    // the parallel mode.
+    int *hits;
+
+    // The pool running the parallel phases of the solve, or NULL to run them
+    // serially.
+    hm_pool *pool;
+
+    // How hm_initialize() reads the costs, one of hm_scan_rows and
+    // hm_scan_columns.
+    int scan;
+
+    // The factor C() applies to each cost: 2 to minimize, or -2 to maximize.
+    int scale;
+
+    // The tolerance used by SNAP(), set by hm_initialize().
+    D eps;
+
+    // The limits of a bounded solve, or NULL to run until optimal.
+    hm_bounds<D> *bounds;
+
+#ifdef HM_STATS
+    // The statistics of the solve, kept in its workspace.
+    hm_stats *stats;
+#endif
 };
 
-static void hm_data_internal_free(hm_data *hm)
-{
-    if (hm->q.data) free(hm->q.data);
-    if (hm->a.data) free(hm->a.data);
-    if (hm->alpha) free(hm->alpha);
-    if (hm->beta) free(hm->beta);
-    if (hm->slack) free(hm->slack);
-    if (hm->nhbor) free(hm->nhbor);
-    if (hm->count) free(hm->count);
-    if (hm->exposed) free(hm->exposed);
-    if (hm->label) free(hm->label);
-}
-
-static hm_data *hm_data_internal_allocate(hm_data *hm, int n)
-{
-    hm->q.data = NULL;
-    hm->a.data = NULL;
-    hm->alpha = NULL;
-    hm->beta = NULL;
-    hm->slack = NULL;
-    hm->nhbor = NULL;
-    hm->count = NULL;
-    hm->exposed = NULL;
-    hm->label = NULL;
-
-    if ((hm->q.data = (int *)malloc(n * sizeof(*hm->q.data))) &&
-        (hm->a.data = (arc *)malloc(n * n * sizeof(*hm->a.data))) &&
-        (hm->alpha = (int *)malloc(n * sizeof(*hm->alpha))) &&
-        (hm->beta = (int *)malloc(n * sizeof(*hm->beta))) &&
-        (hm->slack = (int *)malloc(n * sizeof(*hm->slack))) &&
-        (hm->nhbor = (int *)malloc(n * sizeof(*hm->nhbor))) &&
-        (hm->count = (int *)malloc(n * sizeof(*hm->count))) &&
-        (hm->exposed = (int *)malloc(n * sizeof(*hm->exposed))) &&
-        (hm->label = (int *)malloc(n * sizeof(*hm->label))))
-    {
-        hm->n = n;
-        return hm;
-    }
-
-    hm_data_internal_free(hm);
-    return NULL;
+// The widest cost type the workspace arena must accommodate.
+enum
+{
+    hm_widest_cost = sizeof(int64_t) > sizeof(double) ? sizeof(int64_t)
+                                                      : sizeof(double)
+};
+
+// The number of bytes needed to hold all internally allocated members of an
+// hm_data of any instantiated cost type whose n is at most max_n.
+static size_t hm_data_internal_size(int max_n)
+{
+    size_t n = (size_t)max_n;
+    return 3 * n * hm_widest_cost + 7 * n * sizeof(int)
+        + n * n * (max_n <= hm_narrow_max ? sizeof(uint16_t) : sizeof(int));
+}
+
+// A workspace owns one arena large enough for the internal members of an
+// hm_data of any instantiated cost type with n at most max_n. It may be reused
+// across any number of calls to hungarian_method(), but not concurrently.
+//
+// A workspace created with options may also own a pool, with which it solves
+// problems of at least threshold vertices in parallel. When the solver is
+// compiled with HM_STATS defined, the workspace also keeps the statistics of its
+// last solve.
+struct hm_workspace_
+{
+    int max_n;
+    void *arena;
+    hm_pool *pool;
+    int threshold;
+    int scan;
+#ifdef HM_STATS
+    hm_stats stats; // those of the last solve
+#endif
+};
+
+// Carves the internally allocated members of hm out of the arena of ws, for a
+// given max_n no greater than that of ws. This replaces one malloc() per member
+// with one malloc() per workspace. The cost typed arrays come first so that
+// they inherit the alignment of the arena.
+//
+// The members of U that the slack loops read together, beta, slack, and nhbor,
+// are placed one after another, and the arcs last, behind all the per-vertex
+// arrays, so that those share as few cache lines and pages as possible.
+template <typename T, typename D>
+static void hm_data_internal_bind(hm_data<T, D> *hm, hm_workspace *ws,
+                                  int max_n)
+{
+    D *t = (D *)ws->arena;
+    hm->alpha = t;
+    hm->beta = (t += max_n);
+    hm->slack = (t += max_n);
+
+    int *p = (int *)(t + max_n);
+    hm->nhbor = p;
+    hm->a.size = (p += max_n);
+    hm->q.data = (p += max_n);
+    hm->exposed = (p += 2 * max_n);
+    hm->label = (p += max_n);
+    hm->hits = (p += max_n);
+    p += max_n;
+    hm->a.data = max_n <= hm_narrow_max ? NULL : p;
+    hm->a.narrow = max_n <= hm_narrow_max ? (uint16_t *)p : NULL;
+    hm->pool = NULL;
+    hm->scan = hm_scan_rows;
+    hm->scale = 2;
+    hm->bounds = NULL;
+#ifdef HM_STATS
+    hm->stats = &ws->stats;
+    memset(hm->stats, 0, sizeof(*hm->stats));
+#endif
+}
+
+// The phases of a solve that run in parallel, each member of the pool taking
+// one chunk of V, of U, or of both. See hm_task_run().
+enum
+{
+    hm_phase_initialize,
+    hm_phase_construct,
+    hm_phase_update_slack,
+    hm_phase_min_slack,
+    hm_phase_update_duals,
+    hm_phase_modify_slack
+};
+
+// One parallel phase, with its arguments.
+template <typename T, typename D>
+struct hm_task
+{
+    hm_data<T, D> *hm;
+    int phase;
+    int z;
+    D theta_one;
+};
+
+// The partial result of one member of the pool, kept in its scratch slot.
+template <typename T>
+struct hm_partial
+{
+    T value;
+    int count;
+};
+
+// Sets [*begin, *end) to the chunk of {0,...,n-1} taken by member w of a pool
+// of num_threads members.
+static void hm_chunk(int n, int w, int num_threads, int *begin, int *end)
+{
+    *begin = (int)((int64_t)n * w / num_threads);
+    *end = (int)((int64_t)n * (w + 1) / num_threads);
 }
 
 // This function is for debugging purposes. It prints the algorithm's internal
@@ -167,13 +417,14 @@ static hm_data *hm_data_internal_allocate(hm_data *hm, int n)
 // Hungarian method) beginning on page 252.
 //
 // The formatted output coded here is intended for small numbers.
-static void hm_print(hm_data *hm)
+template <typename T, typename D>
+static void hm_print(hm_data<T, D> *hm)
 {
     int i, j, k;
     printf("\n a\\b |");
     for EACH_U(j)
     {
-        printf("%3d ", BETA(j));
+        printf("%3g ", (double)BETA(j));
     }
 
     printf("mate exposed label\n");
@@ -186,10 +437,10 @@ static void hm_print(hm_data *hm)
     printf("------------------\n");
     for EACH_V(i)
     {
-        printf("     |\n %3d |", ALPHA(i));
+        printf("     |\n %3g |", (double)ALPHA(i));
         for EACH_U(j)
         {
-            printf("%3d ", C(i, j));
+            printf("%3g ", (double)C(i, j));
         }
 
         printf("%4d %7d %5d\n", MATE(i), EXPOSED(i), LABEL(i));
@@ -198,7 +449,7 @@ static void hm_print(hm_data *hm)
     printf("\nslack");
     for EACH_U(j)
     {
-        printf(" %3d", SLACK(j) == INT_MAX ? -1 : SLACK(j));
+        printf(" %3g", SLACK(j) == INF ? -1.0 : (double)SLACK(j));
     }
 
     printf("\nnhbor");
@@ -208,9 +459,12 @@ static void hm_print(hm_data *hm)
     }
 
     printf("\n\nA = { ");
-    for (k = 0; k < A.size; ++k)
+    for EACH_V(i)
     {
-        printf("(%d,%d) ", A.data[k].x, A.data[k].y);
+        for (k = 0; k < A.size[i]; ++k)
+        {
+            printf("(%d,%d) ", i, arc_head(&A, i, k));
+        }
     }
 
     printf("}\nQ = { ");
@@ -225,85 +479,226 @@ static void hm_print(hm_data *hm)
 // See Figure 10-3, "The bipartite matching algorithm", page 224.
 //
 // Corresponds to "procedure augment(v)", but is iterative instead of recursive.
-static void hm_augment(hm_data *hm, int v)
+template <typename T, typename D>
+static void hm_augment(hm_data<T, D> *hm, int v)
 {
+#ifdef HM_STATS
+    int64_t length = 1;
+#endif
     while (LABEL(v) != blank)
     {
         EXPOSED(LABEL(v)) = MATE(v);
         MATE(v) = EXPOSED(v);
         MATE(EXPOSED(v)) = v;
         v = LABEL(v);
+#ifdef HM_STATS
+        length += 2;
+#endif
     }
 
     MATE(v) = EXPOSED(v);
     MATE(EXPOSED(v)) = v;
+#ifdef HM_STATS
+    HM_COUNT(augmentations, 1);
+    HM_COUNT(path_edges, length);
+    if (hm->stats->max_path_edges < length)
+    {
+        hm->stats->max_path_edges = length;
+    }
+#endif
 }
 
 // See Figure 11-2, "The Hungarian method", page 251.
 //
 // Corresponds to lines 7--8.
-static void hm_initialize(hm_data *hm)
+//
+// Sets beta for the columns of U in [N + begin, N + end) to their minima, and
+// returns the largest magnitude among their costs.
+//
+// A column of the row-major costs is n elements apart from one row to the next,
+// so scanning column by column misses the cache on every read once n is large.
+// By default, the minima are instead accumulated one row at a time, reading
+// each row's segment of the chunk sequentially. The column-by-column scan of
+// the text remains available as hm_scan_columns, for comparison.
+template <typename T, typename D>
+static D hm_column_minima(hm_data<T, D> *hm, int begin, int end)
 {
     int i, j;
-    for EACH_V(i)
+    D magnitude = 0;
+    if (hm->scan == hm_scan_rows)
     {
-        MATE(i) = blank;
-        ALPHA(i) = 0;
+        for (j = N + begin; j < N + end; ++j)
+        {
+            BETA(j) = INF;
+        }
+
+        for EACH_V(i)
+        {
+            for (j = N + begin; j < N + end; ++j)
+            {
+                if (C(i, j) < BETA(j))
+                {
+                    BETA(j) = C(i, j);
+                }
+
+                if (magnitude < C(i, j) || magnitude < -C(i, j))
+                {
+                    magnitude = C(i, j) < 0 ? -C(i, j) : C(i, j);
+                }
+            }
+        }
+
+        return magnitude;
     }
 
-    for EACH_U(j)
+    for (j = N + begin; j < N + end; ++j)
     {
-        MATE(j) = blank;
-        BETA(j) = INT_MAX;
+        BETA(j) = INF;
         for EACH_V(i)
         {
             if (C(i, j) < BETA(j))
             {
                 BETA(j) = C(i, j);
             }
+
+            if (magnitude < C(i, j) || magnitude < -C(i, j))
+            {
+                magnitude = C(i, j) < 0 ? -C(i, j) : C(i, j);
+            }
         }
     }
+
+    return magnitude;
 }
 
+template <typename T, typename D>
+static void hm_parallel(hm_data<T, D> *, int, int, D);
+
 // See Figure 11-2, "The Hungarian method", page 251.
 //
-// Corresponds to lines 12--17.
-static void hm_construct_auxiliary_graph(hm_data *hm)
+// Corresponds to lines 7--8.
+template <typename T, typename D>
+static void hm_initialize(hm_data<T, D> *hm)
 {
-    int i, j;
-    A.size = 0;
+    int i, w;
+    D magnitude = 0, part;
+    HM_TIME(initialize_seconds);
     for EACH_V(i)
     {
-        EXPOSED(i) = blank;
-        LABEL(i) = blank;
+        MATE(i) = blank;
+        MATE(N + i) = blank;
+        ALPHA(i) = 0;
+    }
+
+    if (hm->pool)
+    {
+        hm_parallel(hm, hm_phase_initialize, 0, (D)0);
+        for (w = 0; w < hm_pool_size(hm->pool); ++w)
+        {
+            part = ((hm_partial<D> *)hm_pool_slot(hm->pool, w))->value;
+            magnitude = part > magnitude ? part : magnitude;
+        }
+    }
+    else
+    {
+        magnitude = hm_column_minima(hm, 0, N);
+    }
+
+    hm->eps = hm_cost_traits<D>::tolerance(magnitude, N);
+}
 
-        // The following data structure is not included in the Figure 11-2
-        // pseudo-code implementation. It has been added to account for
-        // "labeling" on certain vertices described within Example 11.1 that
-        // would otherwise be missing from the Figure 11-2 implementation.
-        //
-        // count[v] for any v \in V is equal to the size of the set { u \in U :
-        // nhbor[u] = v }. When this set is non-empty, v is considered to be
-        // "labeled". The use of this new data structure is only to complete the
-        // conditional check on "labeled" statuses when updating alpha within
-        // "procedure modify".
-        COUNT(i) = 0;
+// Replaces lines 7--8 of Figure 11-2 when warm starting from a previous
+// solution, whose mate has been set by the caller and whose duals have already
+// been doubled into alpha and beta. Returns the number of stages left to run.
+//
+// The warm start is repaired to satisfy the conditions that the stages rely on:
+// mate must be a matching, each alpha + beta <= c, and each matched edge must be
+// tight. Any inconsistent entry of mate is blanked first. Each alpha is then set
+// to the largest value feasible with beta, which leaves as many edges tight as
+// beta allows, and each matched edge that is still not tight is unmatched.
+template <typename T, typename D>
+static int hm_warm_initialize(hm_data<T, D> *hm)
+{
+    int i, j, num_exposed = 0;
+    D magnitude = 0, tmp;
+    HM_TIME(initialize_seconds);
+    for EACH_V(i)
+    {
+        j = MATE(i);
+        if (j < N || j >= 2 * N || MATE(j) != i)
+        {
+            MATE(i) = blank;
+        }
     }
 
     for EACH_U(j)
     {
-        SLACK(j) = INT_MAX;
+        i = MATE(j);
+        if (i < 0 || i >= N || MATE(i) != j)
+        {
+            MATE(j) = blank;
+        }
+    }
+
+    for EACH_V(i)
+    {
+        ALPHA(i) = INF;
+        for EACH_U(j)
+        {
+            tmp = C(i, j) - BETA(j);
+            if (tmp < ALPHA(i))
+            {
+                ALPHA(i) = tmp;
+            }
 
-        // The following initialization of nhbor[] is necessary for proper usage
-        // of the count[] array, whose addition and purpose is described above.
-        NHBOR(j) = blank;
+            if (magnitude < C(i, j) || magnitude < -C(i, j))
+            {
+                magnitude = C(i, j) < 0 ? -C(i, j) : C(i, j);
+            }
+        }
     }
 
+    hm->eps = hm_cost_traits<D>::tolerance(magnitude, N);
     for EACH_V(i)
+    {
+        j = MATE(i);
+        if (j != blank && SNAP(C(i, j) - ALPHA(i) - BETA(j)) != 0)
+        {
+            MATE(i) = MATE(j) = blank;
+        }
+
+        if (MATE(i) == blank)
+        {
+            ++num_exposed;
+        }
+    }
+
+    return num_exposed;
+}
+
+// See Figure 11-2, "The Hungarian method", page 251.
+//
+// Corresponds to lines 12--17, for the vertices of V in [begin, end) and of U
+// in [N + begin, N + end). Each row only writes its own bucket of A and its own
+// exposed[], so that chunks of rows may be constructed in parallel.
+template <typename T, typename D>
+static void hm_construct_rows(hm_data<T, D> *hm, int begin, int end)
+{
+    int i, j;
+    for (i = begin; i < end; ++i)
+    {
+        A.size[i] = 0;
+        EXPOSED(i) = blank;
+        LABEL(i) = blank;
+        SLACK(N + i) = INF;
+        NHBOR(N + i) = blank;
+    }
+
+    for (i = begin; i < end; ++i)
     {
         for EACH_U(j)
         {
-            if (ALPHA(i) + BETA(j) == C(i, j))
+            if (SNAP(C(i, j) - ALPHA(i) - BETA(j)) == 0)
             {
                 if (MATE(j) == blank)
                 {
@@ -320,39 +715,85 @@ static void hm_construct_auxiliary_graph(hm_data *hm)
 
 // See Figure 11-2, "The Hungarian method", page 251.
 //
-// Corresponds to lines 26--27, 38--39. Called by hm_pre_search() and
-// hm_search().
-static void hm_update_slack(hm_data *hm, int z)
+// Corresponds to lines 12--17.
+template <typename T, typename D>
+static void hm_construct_auxiliary_graph(hm_data<T, D> *hm)
+{
+    HM_TIME(construct_seconds);
+    if (hm->pool)
+    {
+        hm_parallel(hm, hm_phase_construct, 0, (D)0);
+    }
+    else
+    {
+        hm_construct_rows(hm, 0, N);
+    }
+
+    // The arcs are counted here rather than as they are added, as the rows may
+    // have been constructed in parallel.
+#ifdef HM_STATS
+    int i;
+    for EACH_V(i)
+    {
+        HM_COUNT(arcs, A.size[i]);
+    }
+#endif
+}
+
+// See Figure 11-2, "The Hungarian method", page 251.
+//
+// Corresponds to lines 26--27, 38--39, for the vertices of U in [N + begin,
+// N + end). Called by hm_update_slack().
+template <typename T, typename D>
+static void hm_update_slack_range(hm_data<T, D> *hm, int z, int begin, int end)
 {
-    int k, tmp;
-    for EACH_U(k)
+    int k;
+    D tmp;
+    for (k = N + begin; k < N + end; ++k)
     {
-        tmp = C(z, k) - ALPHA(z) - BETA(k);
+        tmp = SNAP(C(z, k) - ALPHA(z) - BETA(k));
         if (0 <= tmp && tmp < SLACK(k))
         {
             SLACK(k) = tmp;
-
-            // The following decrement and increment are necessary to maintain
-            // the count[] array, which is not included in the original Figure
-            // 11-2 implementation, and whose addition and purpose are described
-            // above in hm_construct_auxiliary_graph().
-            if (NHBOR(k) != blank)
-            {
-                --COUNT(NHBOR(k));
-            }
-
-            ++COUNT(z);
             NHBOR(k) = z;
         }
     }
 }
 
+// The int instantiation of hm_update_slack_range(), using the vector kernel
+// selected for the running CPU. See hm_simd.h.
+static void hm_update_slack_range(hm_data<int> *hm, int z, int begin, int end)
+{
+    hm_simd()->update_slack(&hm->c[V(z) * N + begin], hm->scale, ALPHA(z),
+                            hm->beta + begin, hm->slack + begin,
+                            hm->nhbor + begin, z, end - begin);
+}
+
+// See Figure 11-2, "The Hungarian method", page 251.
+//
+// Corresponds to lines 26--27, 38--39. Called by hm_pre_search() and
+// hm_search().
+template <typename T, typename D>
+static void hm_update_slack(hm_data<T, D> *hm, int z)
+{
+    if (hm->pool)
+    {
+        hm_parallel(hm, hm_phase_update_slack, z, (D)0);
+    }
+    else
+    {
+        hm_update_slack_range(hm, z, 0, N);
+    }
+}
+
 // See Figure 11-2, "The Hungarian method", page 251.
 //
 // Corresponds to lines 19--28.
-static bool hm_pre_search(hm_data *hm)
+template <typename T, typename D>
+static bool hm_pre_search(hm_data<T, D> *hm)
 {
     int i;
+    HM_TIME(search_seconds);
     Q.size = 0;
     for EACH_V(i)
     {
@@ -376,33 +817,34 @@ static bool hm_pre_search(hm_data *hm)
 // See Figure 11-2, "The Hungarian method", page 251.
 //
 // Corresponds to lines 29--41.
-static bool hm_search(hm_data *hm)
+template <typename T, typename D>
+static bool hm_search(hm_data<T, D> *hm)
 {
     int i, j, z;
+    HM_TIME(search_seconds);
+    HM_COUNT(searches, 1);
     while (Q.size != 0)
     {
+        // Only the bucket of arcs whose tail is i needs to be visited.
         i = stack_pop(&Q);
-        for (z = 0; z < A.size; ++z)
+        for (z = 0; z < A.size[i]; ++z)
         {
-            if (A.data[z].x == i)
+            j = arc_head(&A, i, z);
+            if (LABEL(j) == blank)
             {
-                j = A.data[z].y;
-                if (LABEL(j) == blank)
+                LABEL(j) = i;
+                if (EXPOSED(j) != blank)
                 {
-                    LABEL(j) = i;
-                    if (EXPOSED(j) != blank)
-                    {
-                        hm_augment(hm, j);
-                        return false; // "go to endstage"
-                    }
-
-                    // The following instruction is listed just before the prior
-                    // conditional in Figure 11-2. Here, it is relocated simply
-                    // because its execution would serve no purpose if the prior
-                    // conditional executes.
-                    stack_push(&Q, j);
-                    hm_update_slack(hm, j);
+                    hm_augment(hm, j);
+                    return false; // "go to endstage"
                 }
+
+                // The following instruction is listed just before the prior
+                // conditional in Figure 11-2. Here, it is relocated simply
+                // because its execution would serve no purpose if the prior
+                // conditional executes.
+                stack_push(&Q, j);
+                hm_update_slack(hm, j);
             }
         }
     }
@@ -412,14 +854,15 @@ static bool hm_search(hm_data *hm)
 
 // See Figure 11-2, "The Hungarian method", page 252.
 //
-// Corresponds to "procedure modify".
-static bool hm_modify(hm_data *hm)
+// Corresponds to the determination of theta_one in "procedure modify", before
+// it is halved, over the vertices of U in [N + begin, N + end). Called by
+// hm_min_slack().
+template <typename T, typename D>
+static D hm_min_slack_range(hm_data<T, D> *hm, int begin, int end)
 {
-    int i, j, theta_one;
-
-    // Determine theta_one.
-    theta_one = INT_MAX;
-    for EACH_U(j)
+    int j;
+    D theta_one = INF;
+    for (j = N + begin; j < N + end; ++j)
     {
         if (0 < SLACK(j) && SLACK(j) < theta_one)
         {
@@ -427,20 +870,30 @@ static bool hm_modify(hm_data *hm)
         }
     }
 
-    theta_one /= 2;
+    return theta_one;
+}
+
+// See Figure 11-2, "The Hungarian method", page 252.
+//
+// Corresponds to the updates of alpha and beta in "procedure modify", for the
+// vertices of V in [begin, end) and of U in [N + begin, N + end). Called by
+// hm_update_duals().
+template <typename T, typename D>
+static void hm_update_duals_range(hm_data<T, D> *hm, D theta_one, int begin,
+                                  int end)
+{
+    int i, j;
 
     // Update the dual variable alpha.
-    for EACH_V(i)
+    for (i = begin; i < end; ++i)
     {
         // The following conditional expression has been changed from its form
-        // in Figure 11-2. Here, an additional check on the count[] array is
-        // performed to account for a certain type of "labeling" that is
-        // mentioned in the Example 11.1 walk-through but is omitted from the
-        // Figure 11-2 implementation.
-        //
-        // See the comments provided near the initialization of count[] in the
-        // function hm_construct_auxiliary_graph().
-        if (LABEL(i) != blank || COUNT(i) > 0)
+        // in Figure 11-2. There, the exposed vertices that seed Q in the
+        // pre-search receive a label of zero, the same as unlabeled vertices,
+        // so their "labeling" (which the Example 11.1 walk-through does show)
+        // is lost. Every such vertex is still unmatched during the stage, so an
+        // additional check on mate[] completes the test.
+        if (LABEL(i) != blank || MATE(i) == blank)
         {
             ALPHA(i) += theta_one;
         }
@@ -451,7 +904,7 @@ static bool hm_modify(hm_data *hm)
     }
 
     // Update the dual variable beta.
-    for EACH_U(j)
+    for (j = N + begin; j < N + end; ++j)
     {
         if (SLACK(j) == 0)
         {
@@ -462,119 +915,1478 @@ static bool hm_modify(hm_data *hm)
             BETA(j) += theta_one;
         }
     }
+}
 
-    // Update slack and check for new admissible edges.
-    for EACH_U(j)
+// The int instantiations of hm_min_slack_range() and hm_update_duals_range(),
+// using the vector kernels selected for the running CPU. See hm_simd.h.
+static int hm_min_slack_range(hm_data<int> *hm, int begin, int end)
+{
+    return hm_simd()->theta(hm->slack + begin, end - begin);
+}
+
+static void hm_update_duals_range(hm_data<int> *hm, int theta_one, int begin,
+                                  int end)
+{
+    hm_simd()->update_duals(hm->alpha + begin, hm->label + begin,
+                            hm->mate + begin, hm->beta + begin,
+                            hm->slack + begin, theta_one, end - begin);
+}
+
+// See Figure 11-2, "The Hungarian method", page 252.
+//
+// Corresponds to the slack updates in "procedure modify", for the vertices of U
+// in [N + begin, N + end). Gathers those whose slack becomes zero into
+// hits[begin], ..., and returns their number. Called by hm_modify() in the
+// parallel mode.
+template <typename T, typename D>
+static int hm_modify_slack_range(hm_data<T, D> *hm, D theta_one, int begin,
+                                 int end)
+{
+    int j, count = 0;
+    for (j = N + begin; j < N + end; ++j)
     {
         if (SLACK(j) > 0)
         {
-            SLACK(j) -= 2 * theta_one;
+            SLACK(j) = SNAP(SLACK(j) - 2 * theta_one);
             if (SLACK(j) == 0)
             {
-                if (MATE(j) == blank)
-                {
-                    EXPOSED(NHBOR(j)) = j;
-                    hm_augment(hm, NHBOR(j));
-                    return false; // "go to endstage"
-                }
-                else
-                {
-                    // The following statement corresponds to a pseudo-code
-                    // command that should be removed from the else-clause of
-                    // the modify procedure in Figure 11-2.
-                    //
-                    // LABEL( MATE( j ) ) = NHBOR( j );
-                    //
-                    // The inclusion of the above statement causes the arc
-                    // added in one of the next statements to never be considered
-                    // in following "search" sub-stages during this stage, and it
-                    // partially duplicates what would happen in these sub-stages
-                    // if the arc were to be considered there. The result of
-                    // inclusion is (often) non-optimality of the algorithm's
-                    // output.
-
-                    // The next statement corresponds to a pseudo-code command
-                    // (in the same else-clause) that should be modified
-                    // slightly. In Figure 11-2, this command "pushes" mate[ u ]
-                    // into Q when it should be "pushing" nhbor[ u ] instead.
-                    // This is because the purpose of this command is to ensure
-                    // that the soon-to-be-added arc will be considered in the
-                    // next "search" sub-stage, and consideration is dependent
-                    // upon the arc-tail, not the arc-head.
-                    stack_push(&Q, NHBOR(j));
-
-                    add_arc(&A, NHBOR(j), MATE(j));
-                }
+                hm->hits[begin + count++] = j;
             }
         }
     }
 
-    return true;
+    return count;
 }
 
-// See Figure 11-2, "The Hungarian method", pages 251--252.
-//
-// Input:
-//
-// mate points to a memory block of at least 2 * n ints. It is used to represent
-// and return the solution matching. See page 223 for a contextual description.
-//
-// c points to a memory block of at least n * n ints. It contains the n*n cost
-// matrix c[ 0...n-1 ][ 0...n-1 ] that implicitly defines the complete bipartite
-// graph G=(V,U,E). The left and right indices respectively comprise vertex
-// labels from V and U.
-//
-// n is the size of V and the size of U.
-//
-// Output:
-//
-// Fills mate with the correct values to represent the solution matching, where
-// V={0,...,n-1} and U={n,...,2n-1}. An edge (v,u) is part of the matching if and
-// only if (v,mate[v])=(mate[u],u).
-void hungarian_method(int *mate, int *c, int n)
+// Runs member w's chunk of the parallel phase ctx, an hm_task.
+template <typename T, typename D>
+static void hm_task_run(void *ctx, int w)
 {
-    // Initialize the algorithm's internal data structures.
-    hm_data hm;
-    if (!hm_data_internal_allocate(&hm, n))
+    static_assert(sizeof(hm_partial<D>) <= hm_pool_slot_size,
+                  "hm_partial must fit a scratch slot of the pool");
+    hm_task<T, D> *task = (hm_task<T, D> *)ctx;
+    hm_data<T, D> *hm = task->hm;
+    hm_partial<D> *partial = (hm_partial<D> *)hm_pool_slot(hm->pool, w);
+    int begin, end;
+    hm_chunk(N, w, hm_pool_size(hm->pool), &begin, &end);
+    switch (task->phase)
+    {
+    case hm_phase_initialize:
+        partial->value = hm_column_minima(hm, begin, end);
+        break;
+
+    case hm_phase_construct:
+        hm_construct_rows(hm, begin, end);
+        break;
+
+    case hm_phase_update_slack:
+        hm_update_slack_range(hm, task->z, begin, end);
+        break;
+
+    case hm_phase_min_slack:
+        partial->value = hm_min_slack_range(hm, begin, end);
+        break;
+
+    case hm_phase_update_duals:
+        hm_update_duals_range(hm, task->theta_one, begin, end);
+        break;
+
+    case hm_phase_modify_slack:
+        partial->count = hm_modify_slack_range(hm, task->theta_one, begin, end);
+        break;
+    }
+}
+
+// Runs the given phase on every member of hm's pool, each over its own chunk.
+template <typename T, typename D>
+static void hm_parallel(hm_data<T, D> *hm, int phase, int z, D theta_one)
+{
+    hm_task<T, D> task;
+    task.hm = hm;
+    task.phase = phase;
+    task.z = z;
+    task.theta_one = theta_one;
+    hm_pool_run(hm->pool, hm_task_run<T, D>, &task);
+}
+
+// See Figure 11-2, "The Hungarian method", page 252.
+//
+// Corresponds to the determination of theta_one in "procedure modify", before
+// it is halved. In the parallel mode, each member reduces its own chunk and the
+// partial minima are reduced here. Called by hm_modify().
+template <typename T, typename D>
+static D hm_min_slack(hm_data<T, D> *hm)
+{
+    int w;
+    D theta_one = INF, part;
+    if (!hm->pool)
+    {
+        return hm_min_slack_range(hm, 0, N);
+    }
+
+    hm_parallel(hm, hm_phase_min_slack, 0, (D)0);
+    for (w = 0; w < hm_pool_size(hm->pool); ++w)
+    {
+        part = ((hm_partial<D> *)hm_pool_slot(hm->pool, w))->value;
+        theta_one = part < theta_one ? part : theta_one;
+    }
+
+    return theta_one;
+}
+
+// See Figure 11-2, "The Hungarian method", page 252.
+//
+// Corresponds to the updates of alpha and beta in "procedure modify". Called by
+// hm_modify().
+template <typename T, typename D>
+static void hm_update_duals(hm_data<T, D> *hm, D theta_one)
+{
+    if (hm->pool)
+    {
+        hm_parallel(hm, hm_phase_update_duals, 0, theta_one);
+    }
+    else
+    {
+        hm_update_duals_range(hm, theta_one, 0, N);
+    }
+}
+
+// See Figure 11-2, "The Hungarian method", page 252.
+//
+// Corresponds to the handling in "procedure modify" of a vertex j of U whose
+// slack has just become zero. Returns false if the stage ends. Called by
+// hm_modify().
+template <typename T, typename D>
+static bool hm_modify_tight(hm_data<T, D> *hm, int j)
+{
+    if (MATE(j) == blank)
+    {
+        EXPOSED(NHBOR(j)) = j;
+        hm_augment(hm, NHBOR(j));
+        return false; // "go to endstage"
+    }
+
+    // The following statement corresponds to a pseudo-code command that should
+    // be removed from the else-clause of the modify procedure in Figure 11-2.
+    //
+    // LABEL( MATE( j ) ) = NHBOR( j );
+    //
+    // The inclusion of the above statement causes the arc added in one of the
+    // next statements to never be considered in following "search" sub-stages
+    // during this stage, and it partially duplicates what would happen in these
+    // sub-stages if the arc were to be considered there. The result of
+    // inclusion is (often) non-optimality of the algorithm's output.
+
+    // The next statement corresponds to a pseudo-code command (in the same
+    // else-clause) that should be modified slightly. In Figure 11-2, this
+    // command "pushes" mate[ u ] into Q when it should be "pushing" nhbor[ u ]
+    // instead. This is because the purpose of this command is to ensure that
+    // the soon-to-be-added arc will be considered in the next "search"
+    // sub-stage, and consideration is dependent upon the arc-tail, not the
+    // arc-head.
+    stack_push(&Q, NHBOR(j));
+
+    add_arc(&A, NHBOR(j), MATE(j));
+    HM_COUNT(arcs, 1);
+    return true;
+}
+
+// See Figure 11-2, "The Hungarian method", page 252.
+//
+// Corresponds to "procedure modify".
+template <typename T, typename D>
+static bool hm_modify(hm_data<T, D> *hm)
+{
+    int j, k, w, begin, end, count;
+    D theta_one;
+    HM_TIME(modify_seconds);
+    HM_COUNT(modifies, 1);
+
+    // Determine theta_one, then update the dual variables alpha and beta.
+    theta_one = hm_min_slack(hm) / 2;
+    hm_update_duals(hm, theta_one);
+
+    // In the parallel mode, the slacks are updated chunk by chunk, and the new
+    // admissible edges are then handled here in the order of the serial loop
+    // below. The serial loop stops at the first exposed vertex, leaving later
+    // slacks stale, but those are reset when the next stage begins.
+    if (hm->pool)
+    {
+        hm_parallel(hm, hm_phase_modify_slack, 0, theta_one);
+        for (w = 0; w < hm_pool_size(hm->pool); ++w)
+        {
+            hm_chunk(N, w, hm_pool_size(hm->pool), &begin, &end);
+            count = ((hm_partial<D> *)hm_pool_slot(hm->pool, w))->count;
+            for (k = 0; k < count; ++k)
+            {
+                if (!hm_modify_tight(hm, hm->hits[begin + k]))
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    // Update slack and check for new admissible edges.
+    for EACH_U(j)
+    {
+        if (SLACK(j) > 0)
+        {
+            SLACK(j) = SNAP(SLACK(j) - 2 * theta_one);
+            if (SLACK(j) == 0 && !hm_modify_tight(hm, j))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// The limits of a bounded solve, and its outcome. The lower bound is kept in a
+// type wide enough to sum n doubled duals: int64_t for integer duals and double
+// otherwise.
+template <typename D>
+struct hm_bounds
+{
+    typedef typename std::conditional<std::numeric_limits<D>::is_integer,
+                                      int64_t, double>::type sum_type;
+
+    sum_type budget;
+    sum_type bound; // the lower bound at the last check
+    bool timed;
+    std::chrono::steady_clock::time_point deadline;
+    int max_stages;
+    int status;
+};
+
+// Returns the dual objective, the sum of alpha and beta, halved to undo the
+// doubling of C(). Since the duals are feasible throughout, alpha[i] + beta[j]
+// <= 2c[i][j], the objective is at most the cost of every perfect matching, and
+// hm_modify() only ever raises it, so it is a running lower bound on the
+// optimum, which it reaches as the last stage ends. For integer costs the
+// optimum is integral, so the halved objective is rounded up.
+template <typename T, typename D>
+static typename hm_bounds<D>::sum_type hm_dual_bound(hm_data<T, D> *hm)
+{
+    typedef typename hm_bounds<D>::sum_type S;
+    int i;
+    S sum = 0;
+    for EACH_V(i)
+    {
+        sum += (S)hm->alpha[i] + (S)hm->beta[i];
+    }
+
+    return hm_cost_traits<S>::half_up(sum);
+}
+
+// Checks the limits of a bounded solve that has completed the given number of
+// stages, or is within a stage if that is negative. Returns true, with the
+// status set, if the solve must stop. A floating-point bound must exceed the
+// budget by more than the solver's tolerance, so that rounding error alone
+// cannot reject a matching costing exactly the budget.
+template <typename T, typename D>
+static bool hm_reached(hm_data<T, D> *hm, int stages)
+{
+    typedef typename hm_bounds<D>::sum_type S;
+    hm_bounds<D> *b = hm->bounds;
+    b->bound = hm_dual_bound(hm);
+    if (b->bound - (S)hm->eps > b->budget)
+    {
+        b->status = hm_status_over_budget;
+    }
+    else if (stages >= 0 && b->max_stages > 0 && stages >= b->max_stages)
+    {
+        b->status = hm_status_stage_limit;
+    }
+    else if (b->timed && std::chrono::steady_clock::now() >= b->deadline)
+    {
+        b->status = hm_status_time_limit;
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
+// See Figure 11-2, "The Hungarian method", pages 251--252.
+//
+// Runs the given number of stages on hm, which must have exactly that many
+// exposed vertices in V, and whose duals must be feasible with every matched
+// edge tight. Each stage augments the matching by one edge.
+//
+// A bounded solve checks its limits before each stage and after each dual
+// update, and stops at the first reached, leaving a partial matching whose
+// edges are all tight.
+template <typename T, typename D>
+static void hm_run_stages(hm_data<T, D> *hm, int num_stages)
+{
+    int s;
+    hm->q.size = 0;
+    hm->a.stride = hm->n;
+    for (s = 1; s <= num_stages; ++s)
+    {
+        if (hm->bounds && hm_reached(hm, s - 1))
+        {
+            return;
+        }
+
+        HM_COUNT(stages, 1);
+        hm_construct_auxiliary_graph(hm);
+        if (hm_pre_search(hm))
+        {
+            while (hm_search(hm) && hm_modify(hm))
+            {
+                if (hm->bounds && hm_reached(hm, -1))
+                {
+                    return;
+                }
+            }
+        }
+    }
+}
+
+// See Figure 11-2, "The Hungarian method", pages 251--252.
+//
+// Runs the Hungarian method on hm, whose mate, c, and n have been set by the
+// caller and whose internal members have been bound to an arena.
+template <typename T, typename D>
+static void hm_solve(hm_data<T, D> *hm)
+{
+    // Run the Hungarian method as described in Section 11.2 and Figure 11-2.
+    hm_initialize(hm);
+    hm_run_stages(hm, hm->n);
+}
+
+// Creates a workspace for solving any problem with n at most max_n. All memory
+// the Hungarian method needs is allocated here, in one block, so that solving
+// with the workspace performs no heap allocation. Returns NULL if max_n is
+// negative or memory is unavailable.
+hm_workspace *hm_workspace_create(int max_n)
+{
+    hm_workspace *ws;
+    if (max_n < 0 || !(ws = (hm_workspace *)malloc(sizeof(*ws))))
+    {
+        return NULL;
+    }
+
+    // One extra byte keeps malloc() from returning NULL when max_n is zero.
+    if (!(ws->arena = malloc(hm_data_internal_size(max_n) + 1)))
+    {
+        free(ws);
+        return NULL;
+    }
+
+    ws->max_n = max_n;
+    ws->pool = NULL;
+    ws->threshold = 0;
+    ws->scan = hm_scan_rows;
+    return ws;
+}
+
+// Sets the options of a workspace to their defaults: one thread per hardware
+// thread, for problems of at least HM_PARALLEL_THRESHOLD vertices, and column
+// minima accumulated row by row.
+void hm_options_init(hm_options *options)
+{
+    options->num_threads = 0;
+    options->parallel_threshold = HM_PARALLEL_THRESHOLD;
+    options->scan = hm_scan_rows;
+}
+
+// As above, but the workspace also owns a pool of options->num_threads threads,
+// the solving thread included (zero or less selects one per hardware thread).
+// Problems of at least options->parallel_threshold vertices are then solved
+// with the O(n) and O(n^2) loops of each stage split across the pool, and
+// smaller problems serially, as the cost of synchronizing every phase exceeds
+// the work of a short loop.
+hm_workspace *hm_workspace_create(int max_n, const hm_options *options)
+{
+    int num_threads = options->num_threads;
+    hm_workspace *ws = hm_workspace_create(max_n);
+    if (!ws)
+    {
+        return NULL;
+    }
+
+    if (num_threads <= 0)
+    {
+        num_threads = (int)std::thread::hardware_concurrency();
+    }
+
+    if (num_threads > 1 && !(ws->pool = hm_pool_create(num_threads)))
+    {
+        hm_workspace_free(ws);
+        return NULL;
+    }
+
+    ws->threshold = options->parallel_threshold;
+    ws->scan = options->scan;
+    return ws;
+}
+
+// Releases a workspace obtained from hm_workspace_create(). Passing NULL is
+// allowed and does nothing.
+void hm_workspace_free(hm_workspace *ws)
+{
+    if (ws)
+    {
+        hm_pool_free(ws->pool);
+        free(ws->arena);
+        free(ws);
+    }
+}
+
+// Returns the largest n that the given workspace can solve.
+int hm_workspace_max_n(const hm_workspace *ws)
+{
+    return ws->max_n;
+}
+
+// Returns the statistics of the last solve with the given workspace, or NULL
+// if the solver was compiled without HM_STATS defined. The statistics are reset
+// as each solve starts, and are valid until the next.
+const hm_stats *hm_workspace_stats(const hm_workspace *ws)
+{
+#ifdef HM_STATS
+    return &ws->stats;
+#else
+    (void)ws;
+    return NULL;
+#endif
+}
+
+// Sets solution->cost from the n matched entries of c, and copies the duals
+// alpha and beta, to which the factor scale was applied, out to the solution's
+// arrays, unless NULL. A scale of 2 or -2 marks the doubled duals of the
+// general solver, which are halved as hungarian_method_warm() halves them, and
+// a negative scale those of a maximization, which are negated. The cost is
+// summed in the wider type of the bounded mode, checking each addition, as n
+// costs within half the range of T may sum beyond it; if the sum leaves that
+// type or T, solution->cost_fits is cleared and solution->cost left zero.
+template <typename T, typename D>
+static void hm_solution_fill(hm_solution<T> *solution, const int *mate,
+                             const T *c, int n, const D *alpha, const D *beta,
+                             int scale)
+{
+    typedef typename hm_bounds<D>::sum_type S;
+    int i;
+    D a, b;
+    S sum = 0;
+    bool fits = true;
+    for (i = 0; i < n; ++i)
+    {
+        fits = fits
+            && hm_cost_traits<S>::add(&sum, (S)c[(size_t)i * n + mate[i] - n]);
+        a = scale == 2 || scale == -2 ? hm_cost_traits<D>::half_down(alpha[i])
+                                      : alpha[i];
+        b = scale == 2 || scale == -2 ? hm_cost_traits<D>::half_up(beta[i])
+                                      : beta[i];
+        if (solution->alpha)
+        {
+            solution->alpha[i] = (T)(scale < 0 ? -a : a);
+        }
+
+        if (solution->beta)
+        {
+            solution->beta[i] = (T)(scale < 0 ? -b : b);
+        }
+    }
+
+    solution->cost_fits = fits && (S)std::numeric_limits<T>::lowest() <= sum
+                          && sum <= (S)std::numeric_limits<T>::max();
+    solution->cost = solution->cost_fits ? (T)sum : 0;
+}
+
+// The fixed-size solver, for problems of K <= HM_FIXED_MAX_N vertices a side.
+// With K known at compile time, every array lives on the stack of the solve,
+// every loop bound is a constant that the compiler may unroll, and the sets of
+// labeled vertices fit in a machine word, so that the arena, the stack Q, and
+// the arc lists of the general solver are all unneeded.
+//
+// Each stage grows a Hungarian tree from one exposed vertex of V rather than a
+// forest from all of them, which for so few vertices costs less than building
+// the auxiliary graph. The duals are those of Section 11.2, but undoubled: with
+// a single tree, alpha and beta move by the least slack itself rather than by
+// half of it, so the costs need not be doubled to keep the duals integral.
+template <int K, typename T, typename D>
+struct hm_fixed
+{
+    D alpha[K];
+    D beta[K];
+    D slack[K];
+    int nhbor[K];
+    int mate_v[K]; // the mate of each vertex of V, as an index in 0..K-1
+    int mate_u[K]; // the mate of each vertex of U, as an index in 0..K-1
+#ifdef HM_STATS
+    hm_stats *stats;
+#endif
+};
+
+// Solves the K*K problem c with costs multiplied by scale, 1 to minimize or -1
+// to maximize, and fills mate as described for hungarian_method().
+template <int K, typename T, typename D>
+static void hm_fixed_solve(hm_workspace *ws, int *mate, const T *c, int scale,
+                           hm_solution<T> *solution)
+{
+    hm_fixed<K, T, D> fixed, *hm = &fixed;
+    int i, j, r, k, edges;
+    uint32_t labeled_v, labeled_u;
+    D x, theta, magnitude = 0, eps;
+#ifdef HM_STATS
+    hm->stats = &ws->stats;
+    memset(hm->stats, 0, sizeof(*hm->stats));
+#else
+    (void)ws;
+#endif
+
+    // Start from alpha = 0 and each beta at its column minimum, as does
+    // hm_initialize().
+    {
+        HM_TIME(initialize_seconds);
+        for (j = 0; j < K; ++j)
+        {
+            hm->alpha[j] = 0;
+            hm->beta[j] = hm_cost_traits<D>::infinity();
+            hm->mate_v[j] = hm->mate_u[j] = blank;
+        }
+
+        for (i = 0; i < K; ++i)
+        {
+            for (j = 0; j < K; ++j)
+            {
+                x = scale * (D)c[i * K + j];
+                hm->beta[j] = x < hm->beta[j] ? x : hm->beta[j];
+                magnitude = x > magnitude ? x : -x > magnitude ? -x : magnitude;
+            }
+        }
+
+        eps = hm_cost_traits<D>::tolerance(magnitude, K);
+    }
+
+    for (r = 0; r < K; ++r)
+    {
+        HM_TIME(search_seconds);
+        HM_COUNT(stages, 1);
+        labeled_v = (uint32_t)1 << r;
+        labeled_u = 0;
+        for (j = 0; j < K; ++j)
+        {
+            hm->slack[j] = hm_cost_traits<D>::snap(
+                scale * (D)c[r * K + j] - hm->alpha[r] - hm->beta[j], eps);
+            hm->nhbor[j] = r;
+        }
+
+        for (;;)
+        {
+            // Find the unlabeled vertex of U with the least slack, and make its
+            // edge tight by moving the duals of the tree.
+            k = blank;
+            for (j = 0; j < K; ++j)
+            {
+                if (!(labeled_u >> j & 1)
+                    && (k == blank || hm->slack[j] < hm->slack[k]))
+                {
+                    k = j;
+                }
+            }
+
+            theta = hm->slack[k];
+            if (theta > 0)
+            {
+                HM_COUNT(modifies, 1);
+                for (j = 0; j < K; ++j)
+                {
+                    if (labeled_v >> j & 1)
+                    {
+                        hm->alpha[j] += theta;
+                    }
+
+                    if (labeled_u >> j & 1)
+                    {
+                        hm->beta[j] -= theta;
+                    }
+                    else
+                    {
+                        hm->slack[j] = hm_cost_traits<D>::snap(
+                            hm->slack[j] - theta, eps);
+                    }
+                }
+            }
+
+            // An exposed vertex of U ends the stage with an augmentation along
+            // the tree. Otherwise its mate joins the tree.
+            labeled_u |= (uint32_t)1 << k;
+            if (hm->mate_u[k] == blank)
+            {
+                break;
+            }
+
+            i = hm->mate_u[k];
+            labeled_v |= (uint32_t)1 << i;
+            for (j = 0; j < K; ++j)
+            {
+                x = hm_cost_traits<D>::snap(
+                    scale * (D)c[i * K + j] - hm->alpha[i] - hm->beta[j], eps);
+                if (!(labeled_u >> j & 1) && x < hm->slack[j])
+                {
+                    hm->slack[j] = x;
+                    hm->nhbor[j] = i;
+                }
+            }
+        }
+
+        edges = -1;
+        do
+        {
+            i = hm->nhbor[k];
+            j = hm->mate_v[i];
+            hm->mate_v[i] = k;
+            hm->mate_u[k] = i;
+            k = j;
+            edges += 2;
+        }
+        while (i != r);
+
+#ifdef HM_STATS
+        HM_COUNT(augmentations, 1);
+        HM_COUNT(path_edges, edges);
+        if (hm->stats->max_path_edges < edges)
+        {
+            hm->stats->max_path_edges = edges;
+        }
+#endif
+    }
+
+    for (i = 0; i < K; ++i)
+    {
+        mate[i] = K + hm->mate_v[i];
+        mate[K + hm->mate_v[i]] = i;
+    }
+
+    if (solution)
+    {
+        hm_solution_fill(solution, mate, c, K, hm->alpha, hm->beta, scale);
+    }
+}
+
+// Solves the n*n problem c with the instantiation of hm_fixed_solve() for n,
+// which must lie in 1..HM_FIXED_MAX_N.
+template <typename T, typename D>
+static void hm_fixed_dispatch(hm_workspace *ws, int *mate, const T *c, int n,
+                              int scale, hm_solution<T> *solution)
+{
+#define HM_FIXED_CASE(k_) \
+    case k_: hm_fixed_solve<k_, T, D>(ws, mate, c, scale, solution); break;
+    switch (n)
+    {
+    HM_FIXED_CASE(1)  HM_FIXED_CASE(2)  HM_FIXED_CASE(3)  HM_FIXED_CASE(4)
+    HM_FIXED_CASE(5)  HM_FIXED_CASE(6)  HM_FIXED_CASE(7)  HM_FIXED_CASE(8)
+    HM_FIXED_CASE(9)  HM_FIXED_CASE(10) HM_FIXED_CASE(11) HM_FIXED_CASE(12)
+    HM_FIXED_CASE(13) HM_FIXED_CASE(14) HM_FIXED_CASE(15) HM_FIXED_CASE(16)
+    }
+#undef HM_FIXED_CASE
+}
+
+static_assert(HM_FIXED_MAX_N <= 16, "HM_FIXED_MAX_N must be at most 16");
+
+// Solves with duals and slacks of type D on the arena of ws, in the given
+// objective sense, and fills solution unless it is NULL, as described for the
+// entry points below. Problems of at most HM_FIXED_MAX_N vertices a side go to
+// the fixed-size solver, unless the workspace would solve them in parallel.
+template <typename T, typename D>
+static bool hm_solve_in(hm_workspace *ws, int *mate, const T *c, int n,
+                        int sense, hm_solution<T> *solution)
+{
+    if (n > ws->max_n)
+    {
+        return false;
+    }
+
+    hm_pool *pool = n >= ws->threshold ? ws->pool : NULL;
+    if (n > 0 && n <= HM_FIXED_MAX_N && !pool)
+    {
+        hm_fixed_dispatch<T, D>(ws, mate, c, n,
+                                sense == hm_maximize ? -1 : 1, solution);
+        return true;
+    }
+
+    hm_data<T, D> hm;
+    hm_data_internal_bind(&hm, ws, n);
+    hm.mate = mate;
+    hm.c = c;
+    hm.n = n;
+    hm.pool = pool;
+    hm.scan = ws->scan;
+    hm.scale = sense == hm_maximize ? -2 : 2;
+    hm_solve(&hm);
+    if (solution)
+    {
+        hm_solution_fill(solution, mate, c, n, hm.alpha, hm.beta, hm.scale);
+    }
+
+    return true;
+}
+
+// See Figure 11-2, "The Hungarian method", pages 251--252.
+//
+// Input:
+//
+// ws points to a workspace created by hm_workspace_create() with a max_n of at
+// least n.
+//
+// mate, c, and n are as described for hungarian_method() below.
+//
+// Output:
+//
+// Returns false, leaving mate untouched, if n exceeds the capacity of ws.
+// Otherwise fills mate as described for hungarian_method() below and returns
+// true.
+template <typename T>
+bool hungarian_method(hm_workspace *ws, int *mate, const T *c, int n)
+{
+    return hm_solve_in<T, T>(ws, mate, c, n, hm_minimize, NULL);
+}
+
+// As above, but in the given objective sense: hm_minimize, or hm_maximize to
+// find a matching of maximum total cost. Maximizing reads each cost negated,
+// through C(), rather than from a negated copy of the matrix. Transforms such
+// as (max - c) need no option of their own, as adding a constant to every cost
+// adds n times it to every matching, which leaves the optimum unchanged.
+template <typename T>
+bool hungarian_method(hm_workspace *ws, int *mate, const T *c, int n,
+                      int sense)
+{
+    return hm_solve_in<T, T>(ws, mate, c, n, sense, NULL);
+}
+
+// As above, and also sets solution->cost to the cost of the matching found,
+// summed from its n entries of c rather than from the whole matrix, and copies
+// the final duals to solution->alpha and solution->beta, n values each, unless
+// they are NULL. solution->cost_fits is set, or cleared, with the cost left
+// zero, if that cost lies outside the range of T, as the sum of n costs within
+// half that range may. The duals are halved back from the solver's doubled
+// units, as hungarian_method_warm() does, and so certify the optimum: when
+// minimizing, alpha[i] + beta[j] <= c[i][j] for all i and j, and when
+// maximizing, the duals are negated so that alpha[i] + beta[j] >= c[i][j].
+// Either way equality holds on each edge of the matching, so the duals sum to
+// the cost, and they may be passed back to hungarian_method_warm() to re-solve
+// after a change.
+template <typename T>
+bool hungarian_method(hm_workspace *ws, int *mate, const T *c, int n,
+                      int sense, hm_solution<T> *solution)
+{
+    return hm_solve_in<T, T>(ws, mate, c, n, sense, solution);
+}
+
+// See Figure 11-2, "The Hungarian method", pages 251--252.
+//
+// Input:
+//
+// mate points to a memory block of at least 2 * n ints. It is used to represent
+// and return the solution matching. See page 223 for a contextual description.
+//
+// c points to a memory block of at least n * n ints. It contains the n*n cost
+// matrix c[ 0...n-1 ][ 0...n-1 ] that implicitly defines the complete bipartite
+// graph G=(V,U,E). The left and right indices respectively comprise vertex
+// labels from V and U. Since c is only ever read, any number of threads may
+// solve against the same matrix concurrently, each with its own workspace.
+//
+// The cost type T may be any of int32_t, int64_t, float, and double, for which
+// the solver is instantiated below. Integer costs must lie within half the
+// range of T, as costs are doubled internally; hungarian_method_wide() lifts
+// this limit for int32_t costs. Floating-point costs should be finite; edges
+// are considered tight when their reduced cost is within a small tolerance of
+// zero.
+//
+// n is the size of V and the size of U.
+//
+// Output:
+//
+// Fills mate with the correct values to represent the solution matching, where
+// V={0,...,n-1} and U={n,...,2n-1}. An edge (v,u) is part of the matching if and
+// only if (v,mate[v])=(mate[u],u).
+template <typename T>
+void hungarian_method(int *mate, const T *c, int n)
+{
+    // Initialize the algorithm's internal data structures, solve, and clean up.
+    // Callers solving many problems should create their own workspace instead.
+    hm_workspace *ws = hm_workspace_create(n);
+    if (!ws)
+    {
+        return;
+    }
+
+    hungarian_method(ws, mate, c, n);
+    hm_workspace_free(ws);
+}
+
+// The wide mode of hungarian_method(), for int32_t costs of any magnitude. The
+// duals and slacks are kept as int64_t, so that doubling the costs and summing
+// them into duals cannot overflow, as it can when they are kept as int32_t for
+// costs beyond half its range. The vector kernels of hm_simd.h work on 32-bit
+// values, so this mode runs the scalar loops.
+bool hungarian_method_wide(hm_workspace *ws, int *mate, const int32_t *c, int n)
+{
+    return hm_solve_in<int32_t, int64_t>(ws, mate, c, n, hm_minimize, NULL);
+}
+
+void hungarian_method_wide(int *mate, const int32_t *c, int n)
+{
+    hm_workspace *ws = hm_workspace_create(n);
+    if (!ws)
     {
         return;
     }
 
+    hungarian_method_wide(ws, mate, c, n);
+    hm_workspace_free(ws);
+}
+
+// Sets limits to none: no time limit and no stage limit.
+void hm_limits_init(hm_limits *limits)
+{
+    limits->seconds = 0;
+    limits->max_stages = 0;
+}
+
+// The bounded mode of hungarian_method(), for callers who only need a matching
+// within a budget, or who can use a partial answer after a fixed amount of
+// work. The dual objective is checked before each stage and after each dual
+// update; each check costs O(n), as do the dual updates themselves, so a
+// bounded solve keeps the O(n^3) of the unbounded one.
+//
+// Input:
+//
+// ws, mate, c, and n are as described for hungarian_method() above.
+//
+// budget is the greatest cost acceptable, or the largest value of T for none.
+//
+// limits points to the time and stage limits, or is NULL for none. The time
+// limit is measured from the call, and the stage limit counts the edges to
+// match, one per stage, before stopping.
+//
+// Output:
+//
+// Returns hm_status_too_large, leaving mate and *bound untouched, if n exceeds
+// the capacity of ws. Otherwise sets *bound to a lower bound on the cost of
+// every matching, and returns:
+//
+// hm_status_optimal if mate holds an optimal matching within the budget. *bound
+// is then its cost.
+//
+// hm_status_over_budget if *bound exceeds the budget, so that no matching is
+// within it. mate holds a partial matching, or the optimal one if the bound was
+// only found to exceed the budget as the solve completed.
+//
+// hm_status_time_limit or hm_status_stage_limit if a limit was reached first.
+// mate holds the partial matching found so far, with unmatched vertices blank
+// (negative), as the best partial answer: each of its edges is tight under the
+// duals whose objective gives *bound.
+//
+// The bound is summed in a wider type than T, and may not fit T. A bound above
+// the largest value of T exceeds every budget, so the status is then
+// hm_status_over_budget, and *bound is that largest value, which is still a
+// lower bound. A bound below the least value of T, as when an optimal matching
+// of int32_t costs sums below INT32_MIN, is reported as hm_status_out_of_range,
+// leaving *bound untouched, with mate as it would be under the other status.
+template <typename T>
+int hungarian_method_bounded(hm_workspace *ws, int *mate, const T *c, int n,
+                             T budget, const hm_limits *limits, T *bound)
+{
+    typedef typename hm_bounds<T>::sum_type S;
+    if (n > ws->max_n)
+    {
+        return hm_status_too_large;
+    }
+
+    hm_data<T> hm;
+    hm_bounds<T> bounds;
+    hm_data_internal_bind(&hm, ws, n);
     hm.mate = mate;
     hm.c = c;
+    hm.n = n;
+    hm.pool = n >= ws->threshold ? ws->pool : NULL;
+    hm.scan = ws->scan;
+    hm.bounds = &bounds;
+    bounds.budget = budget;
+    bounds.timed = limits && limits->seconds > 0;
+    bounds.max_stages = limits ? limits->max_stages : 0;
+    bounds.status = hm_status_optimal;
+    if (bounds.timed)
+    {
+        bounds.deadline = std::chrono::steady_clock::now()
+            + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                  std::chrono::duration<double>(limits->seconds));
+    }
 
-    // Double each cost to ensure integrality of the alphabeta algorithm.
-    int i, j;
+    hm_solve(&hm);
+
+    // The final objective is the optimum, which may still exceed the budget.
+    if (bounds.status == hm_status_optimal)
+    {
+        bounds.bound = hm_dual_bound(&hm);
+        if (bounds.bound - hm.eps > bounds.budget)
+        {
+            bounds.status = hm_status_over_budget;
+        }
+    }
+
+    if (bounds.bound > (S)std::numeric_limits<T>::max())
+    {
+        *bound = std::numeric_limits<T>::max();
+    }
+    else if (bounds.bound < (S)std::numeric_limits<T>::lowest())
+    {
+        return hm_status_out_of_range;
+    }
+    else
+    {
+        *bound = (T)bounds.bound;
+    }
+
+    return bounds.status;
+}
+
+// Input:
+//
+// ws, c, and n are as described for hungarian_method() above.
+//
+// mate, alpha, and beta hold a previous solution to start from, typically the
+// output of an earlier call on slightly different costs. mate is as described
+// for hungarian_method() below, except that any of its entries may be negative
+// to leave a vertex unmatched. alpha and beta point to n values each, the duals
+// of V and U. They need not be feasible for c, but c[i][j] - beta[j] must not
+// overflow T.
+//
+// Output:
+//
+// Returns false, leaving mate, alpha, and beta untouched, if n exceeds the
+// capacity of ws. Otherwise repairs the previous solution against c (see
+// hm_warm_initialize()), runs one stage per vertex it leaves unmatched, and
+// returns true. mate then holds an optimal matching, and alpha and beta hold
+// optimal duals: alpha[i] + beta[j] <= c[i][j] for all i and j, with equality
+// on each edge of the matching. The input alpha is fully recomputed from beta,
+// so only mate and beta carry information into the solve.
+template <typename T>
+bool hungarian_method_warm(hm_workspace *ws, int *mate, T *alpha, T *beta,
+                           const T *c, int n)
+{
+    if (n > ws->max_n)
+    {
+        return false;
+    }
+
+    int i;
+    hm_data<T> hm;
+    hm_data_internal_bind(&hm, ws, n);
+    hm.mate = mate;
+    hm.c = c;
+    hm.n = n;
+    hm.pool = n >= ws->threshold ? ws->pool : NULL;
+    hm.scan = ws->scan;
+    for (i = 0; i < n; ++i)
+    {
+        hm.beta[i] = 2 * beta[i];
+    }
+
+    hm_run_stages(&hm, hm_warm_initialize(&hm));
     for (i = 0; i < n; ++i)
     {
-        for (j = 0; j < n; ++j)
+        alpha[i] = hm_cost_traits<T>::half_down(hm.alpha[i]);
+        beta[i] = hm_cost_traits<T>::half_up(hm.beta[i]);
+    }
+
+    return true;
+}
+
+// As above, but with a workspace of its own. Returns false if memory is
+// unavailable.
+template <typename T>
+bool hungarian_method_warm(int *mate, T *alpha, T *beta, const T *c, int n)
+{
+    hm_workspace *ws = hm_workspace_create(n);
+    if (!ws)
+    {
+        return false;
+    }
+
+    hungarian_method_warm(ws, mate, alpha, beta, c, n);
+    hm_workspace_free(ws);
+    return true;
+}
+
+// A dynamic solver keeps the state of a solved problem alive, together with a
+// copy of its costs, so that the optimum can be restored after a small change
+// by running a single stage rather than all n. See hm_dynamic_create().
+template <typename T>
+struct hm_dynamic
+{
+    hm_workspace *ws;
+    hm_data<T> hm;
+    int max_n;
+    int *mate;   // 2 * max_n ints, the solver's own matching
+    T *c;        // max_n * max_n costs, stored with a stride of the current n
+    T magnitude; // the largest doubled cost magnitude ever held
+};
+
+// Returns whether each of the given costs can be doubled, and negated, within
+// T, as C() requires. Each cost is compared against half the limit, since
+// doubling the costs rejected here would itself overflow.
+template <typename T>
+static bool hm_dynamic_fits(const T *c, int count)
+{
+    const T limit = std::numeric_limits<T>::max() / 2;
+    int k;
+    for (k = 0; k < count; ++k)
+    {
+        if (c[k] > limit || c[k] < -limit)
         {
-            c[i * n + j] *= 2;
+            return false;
         }
     }
 
-    // Run the Hungarian method as described in Section 11.2 and Figure 11-2.
-    int s;
-    hm_initialize(&hm);
-    hm.q.size = 0;
-    hm.a.size = 0;
-    for (s = 1; s <= n; ++s)
+    return true;
+}
+
+// Widens the magnitude of d to cover the given costs, which must fit as
+// hm_dynamic_fits() checks, and sets the tolerance of SNAP() from it.
+template <typename T>
+static void hm_dynamic_widen(hm_dynamic<T> *d, const T *c, int count)
+{
+    int k;
+    for (k = 0; k < count; ++k)
+    {
+        T doubled = c[k] < 0 ? -2 * c[k] : 2 * c[k];
+        if (d->magnitude < doubled)
+        {
+            d->magnitude = doubled;
+        }
+    }
+
+    d->hm.eps = hm_cost_traits<T>::tolerance(d->magnitude, d->hm.n);
+}
+
+// Unmatches i (of V or U) and its mate, if any.
+template <typename T>
+static void hm_unmatch(hm_data<T> *hm, int i)
+{
+    if (MATE(i) != blank)
+    {
+        MATE(MATE(i)) = blank;
+        MATE(i) = blank;
+    }
+}
+
+// Restores the optimum of d after the caller's change has left its duals
+// feasible and every matched edge tight. A change touching one row and/or one
+// column exposes at most one vertex of V, so this runs at most one stage.
+template <typename T>
+static void hm_dynamic_resolve(hm_dynamic<T> *d)
+{
+    hm_data<T> *hm = &d->hm;
+    int i, num_exposed = 0;
+    for EACH_V(i)
+    {
+        if (MATE(i) == blank)
+        {
+            ++num_exposed;
+        }
+    }
+
+    hm_run_stages(hm, num_exposed);
+}
+
+// Input:
+//
+// c and n are as described for hungarian_method() below. c is copied, and may
+// be released by the caller on return.
+//
+// max_n is the largest n to which the problem may grow with hm_dynamic_add().
+//
+// Output:
+//
+// Returns a dynamic solver holding the solved problem, or NULL if n exceeds
+// max_n, a cost exceeds half the range of T in magnitude, or memory is
+// unavailable. The solver must be released with hm_dynamic_free().
+template <typename T>
+hm_dynamic<T> *hm_dynamic_create(const T *c, int n, int max_n)
+{
+    hm_dynamic<T> *d;
+    if (n < 0 || n > max_n || !hm_dynamic_fits(c, n * n)
+        || !(d = (hm_dynamic<T> *)malloc(sizeof(*d))))
+    {
+        return NULL;
+    }
+
+    // One extra element keeps malloc() from returning NULL when max_n is zero.
+    d->ws = hm_workspace_create(max_n);
+    d->mate = (int *)malloc((2 * (size_t)max_n + 1) * sizeof(*d->mate));
+    d->c = (T *)malloc(((size_t)max_n * max_n + 1) * sizeof(*d->c));
+    if (!d->ws || !d->mate || !d->c)
+    {
+        hm_dynamic_free(d);
+        return NULL;
+    }
+
+    // The internal members are bound for max_n, so that their positions in the
+    // arena stay fixed as n changes.
+    int k;
+    for (k = 0; k < n * n; ++k)
+    {
+        d->c[k] = c[k];
+    }
+
+    d->max_n = max_n;
+    hm_data_internal_bind(&d->hm, d->ws, max_n);
+    d->hm.mate = d->mate;
+    d->hm.c = d->c;
+    d->hm.n = n;
+    d->magnitude = 0;
+    hm_solve(&d->hm);
+    hm_dynamic_widen(d, d->c, n * n);
+    return d;
+}
+
+// Releases a dynamic solver obtained from hm_dynamic_create(). Passing NULL is
+// allowed and does nothing.
+template <typename T>
+void hm_dynamic_free(hm_dynamic<T> *d)
+{
+    if (d)
+    {
+        hm_workspace_free(d->ws);
+        free(d->mate);
+        free(d->c);
+        free(d);
+    }
+}
+
+// Returns the current n of d.
+template <typename T>
+int hm_dynamic_n(const hm_dynamic<T> *d)
+{
+    return d->hm.n;
+}
+
+// Returns the current optimal matching of d, as described for mate in
+// hungarian_method() below. It remains valid until d is next changed or freed.
+template <typename T>
+const int *hm_dynamic_mate(const hm_dynamic<T> *d)
+{
+    return d->mate;
+}
+
+// Replaces the costs of row i (0 <= i < n) with the n given costs, and restores
+// the optimum. Returns false, changing nothing, if i is out of range or a cost
+// exceeds half the range of T in magnitude.
+//
+// Row i is unmatched, and alpha[i] is reset to the largest value feasible with
+// beta. No other edge's reduced cost changes.
+template <typename T>
+bool hm_dynamic_update_row(hm_dynamic<T> *d, int i, const T *row)
+{
+    hm_data<T> *hm = &d->hm;
+    int j;
+    if (i < 0 || i >= N || !hm_dynamic_fits(row, N))
+    {
+        return false;
+    }
+
+    for EACH_U(j)
+    {
+        d->c[V(i) * N + U(j)] = row[U(j)];
+    }
+
+    hm_dynamic_widen(d, row, N);
+    hm_unmatch(hm, i);
+    ALPHA(i) = INF;
+    for EACH_U(j)
+    {
+        if (C(i, j) - BETA(j) < ALPHA(i))
+        {
+            ALPHA(i) = C(i, j) - BETA(j);
+        }
+    }
+
+    hm_dynamic_resolve(d);
+    return true;
+}
+
+// Replaces the costs of column k (0 <= k < n) with the n given costs, and
+// restores the optimum. Returns false, changing nothing, if k is out of range
+// or a cost exceeds half the range of T in magnitude.
+//
+// Column k is unmatched, and its beta is reset to the largest value feasible
+// with alpha. No other edge's reduced cost changes.
+template <typename T>
+bool hm_dynamic_update_col(hm_dynamic<T> *d, int k, const T *col)
+{
+    hm_data<T> *hm = &d->hm;
+    int i, j = N + k;
+    if (k < 0 || k >= N || !hm_dynamic_fits(col, N))
+    {
+        return false;
+    }
+
+    for EACH_V(i)
+    {
+        d->c[V(i) * N + k] = col[V(i)];
+    }
+
+    hm_dynamic_widen(d, col, N);
+    hm_unmatch(hm, j);
+    BETA(j) = INF;
+    for EACH_V(i)
+    {
+        if (C(i, j) - ALPHA(i) < BETA(j))
+        {
+            BETA(j) = C(i, j) - ALPHA(i);
+        }
+    }
+
+    hm_dynamic_resolve(d);
+    return true;
+}
+
+// Grows the problem by one row and one column, both numbered n, and restores
+// the optimum. row holds the n + 1 costs of the new row, the last being its cost
+// to the new column, and col holds the n costs of the existing rows to the new
+// column. Returns false, changing nothing, if n already equals max_n or a cost
+// exceeds half the range of T in magnitude.
+//
+// As the problem stays square, a row cannot be added alone. Every U label in the
+// matching grows by one, as U becomes {n+1,...,2n+1}.
+template <typename T>
+bool hm_dynamic_add(hm_dynamic<T> *d, const T *row, const T *col)
+{
+    hm_data<T> *hm = &d->hm;
+    int i, j, n = N;
+    if (n == d->max_n || !hm_dynamic_fits(row, n + 1)
+        || !hm_dynamic_fits(col, n))
+    {
+        return false;
+    }
+
+    // Widen the stride of the costs from n to n + 1, from the back so that no
+    // cost is overwritten before it is moved.
+    for (i = n - 1; i >= 0; --i)
+    {
+        d->c[i * (n + 1) + n] = col[i];
+        for (j = n - 1; j >= 0; --j)
+        {
+            d->c[i * (n + 1) + j] = d->c[i * n + j];
+        }
+    }
+
+    for (j = 0; j <= n; ++j)
     {
-        hm_construct_auxiliary_graph(&hm);
-        if (hm_pre_search(&hm))
+        d->c[n * (n + 1) + j] = row[j];
+    }
+
+    // Relabel U, again from the back, and add the two new vertices unmatched.
+    for (j = 2 * n - 1; j >= n; --j)
+    {
+        d->mate[j + 1] = d->mate[j];
+    }
+
+    for (i = 0; i < n; ++i)
+    {
+        if (d->mate[i] != blank)
         {
-            while (hm_search(&hm) && hm_modify(&hm));
+            ++d->mate[i];
         }
     }
 
-    // Reset (halve) each cost and clean up.
+    d->mate[n] = d->mate[2 * n + 1] = blank;
+    hm->n = n + 1;
+    hm_dynamic_widen(d, col, n);
+    hm_dynamic_widen(d, row, n + 1);
+
+    // The new column's beta is the largest value feasible with the existing
+    // alphas, and the new row's alpha the largest feasible with every beta.
+    BETA(2 * n + 1) = INF;
     for (i = 0; i < n; ++i)
     {
-        for (j = 0; j < n; ++j)
+        if (C(i, 2 * n + 1) - ALPHA(i) < BETA(2 * n + 1))
+        {
+            BETA(2 * n + 1) = C(i, 2 * n + 1) - ALPHA(i);
+        }
+    }
+
+    ALPHA(n) = INF;
+    for EACH_U(j)
+    {
+        if (C(n, j) - BETA(j) < ALPHA(n))
+        {
+            ALPHA(n) = C(n, j) - BETA(j);
+        }
+    }
+
+    hm_dynamic_resolve(d);
+    return true;
+}
+
+// Shrinks the problem by removing row i and column k (0 <= i, k < n), and
+// restores the optimum. Rows and columns after those removed move down by one.
+// Returns false, changing nothing, if i or k is out of range.
+//
+// Removing a row together with the column it is matched to, as when a worker
+// leaves with its task, keeps the remaining matching optimal and runs no stage.
+template <typename T>
+bool hm_dynamic_remove(hm_dynamic<T> *d, int i, int k)
+{
+    hm_data<T> *hm = &d->hm;
+    int x, y, m, n = N;
+    if (i < 0 || i >= n || k < 0 || k >= n)
+    {
+        return false;
+    }
+
+    hm_unmatch(hm, i);
+    hm_unmatch(hm, n + k);
+
+    // Compact the costs to a stride of n - 1, from the front so that no cost is
+    // overwritten before it is moved.
+    for (x = 0; x < n; ++x)
+    {
+        for (y = 0; y < n; ++y)
+        {
+            if (x != i && y != k)
+            {
+                d->c[(x - (x > i)) * (n - 1) + y - (y > k)] = d->c[x * n + y];
+            }
+        }
+    }
+
+    // Compact the matching and the duals, relabelling U as {n-1,...,2n-3}.
+    for (x = 0; x < n; ++x)
+    {
+        if (x != i)
+        {
+            m = d->mate[x];
+            if (m != blank)
+            {
+                m -= n;
+                m = n - 1 + m - (m > k);
+            }
+
+            d->mate[x - (x > i)] = m;
+            hm->alpha[x - (x > i)] = hm->alpha[x];
+        }
+    }
+
+    for (y = 0; y < n; ++y)
+    {
+        if (y != k)
         {
-            c[i * n + j] /= 2;
+            m = d->mate[n + y];
+            if (m != blank)
+            {
+                m -= m > i;
+            }
+
+            d->mate[n - 1 + y - (y > k)] = m;
+            hm->beta[y - (y > k)] = hm->beta[y];
         }
     }
 
-    hm_data_internal_free(&hm);
+    hm->n = n - 1;
+    hm->eps = hm_cost_traits<T>::tolerance(d->magnitude, hm->n);
+    hm_dynamic_resolve(d);
+    return true;
 }
+
+// The cost types for which the solver is compiled.
+template bool hungarian_method(hm_workspace *, int *, const int32_t *, int);
+template bool hungarian_method(hm_workspace *, int *, const int64_t *, int);
+template bool hungarian_method(hm_workspace *, int *, const float *, int);
+template bool hungarian_method(hm_workspace *, int *, const double *, int);
+template void hungarian_method(int *, const int32_t *, int);
+template void hungarian_method(int *, const int64_t *, int);
+template void hungarian_method(int *, const float *, int);
+template void hungarian_method(int *, const double *, int);
+template bool hungarian_method(hm_workspace *, int *, const int32_t *, int,
+                               int);
+template bool hungarian_method(hm_workspace *, int *, const int64_t *, int,
+                               int);
+template bool hungarian_method(hm_workspace *, int *, const float *, int, int);
+template bool hungarian_method(hm_workspace *, int *, const double *, int,
+                               int);
+template bool hungarian_method(hm_workspace *, int *, const int32_t *, int,
+                               int, hm_solution<int32_t> *);
+template bool hungarian_method(hm_workspace *, int *, const int64_t *, int,
+                               int, hm_solution<int64_t> *);
+template bool hungarian_method(hm_workspace *, int *, const float *, int, int,
+                               hm_solution<float> *);
+template bool hungarian_method(hm_workspace *, int *, const double *, int,
+                               int, hm_solution<double> *);
+template int hungarian_method_bounded(hm_workspace *, int *, const int32_t *,
+                                      int, int32_t, const hm_limits *,
+                                      int32_t *);
+template int hungarian_method_bounded(hm_workspace *, int *, const int64_t *,
+                                      int, int64_t, const hm_limits *,
+                                      int64_t *);
+template int hungarian_method_bounded(hm_workspace *, int *, const float *,
+                                      int, float, const hm_limits *, float *);
+template int hungarian_method_bounded(hm_workspace *, int *, const double *,
+                                      int, double, const hm_limits *, double *);
+template bool hungarian_method_warm(hm_workspace *, int *, int32_t *,
+                                    int32_t *, const int32_t *, int);
+template bool hungarian_method_warm(hm_workspace *, int *, int64_t *,
+                                    int64_t *, const int64_t *, int);
+template bool hungarian_method_warm(hm_workspace *, int *, float *, float *,
+                                    const float *, int);
+template bool hungarian_method_warm(hm_workspace *, int *, double *, double *,
+                                    const double *, int);
+template bool hungarian_method_warm(int *, int32_t *, int32_t *,
+                                    const int32_t *, int);
+template bool hungarian_method_warm(int *, int64_t *, int64_t *,
+                                    const int64_t *, int);
+template bool hungarian_method_warm(int *, float *, float *, const float *,
+                                    int);
+template bool hungarian_method_warm(int *, double *, double *, const double *,
+                                    int);
+template hm_dynamic<int32_t> *hm_dynamic_create(const int32_t *, int, int);
+template hm_dynamic<int64_t> *hm_dynamic_create(const int64_t *, int, int);
+template hm_dynamic<float> *hm_dynamic_create(const float *, int, int);
+template hm_dynamic<double> *hm_dynamic_create(const double *, int, int);
+template void hm_dynamic_free(hm_dynamic<int32_t> *);
+template void hm_dynamic_free(hm_dynamic<int64_t> *);
+template void hm_dynamic_free(hm_dynamic<float> *);
+template void hm_dynamic_free(hm_dynamic<double> *);
+template int hm_dynamic_n(const hm_dynamic<int32_t> *);
+template int hm_dynamic_n(const hm_dynamic<int64_t> *);
+template int hm_dynamic_n(const hm_dynamic<float> *);
+template int hm_dynamic_n(const hm_dynamic<double> *);
+template const int *hm_dynamic_mate(const hm_dynamic<int32_t> *);
+template const int *hm_dynamic_mate(const hm_dynamic<int64_t> *);
+template const int *hm_dynamic_mate(const hm_dynamic<float> *);
+template const int *hm_dynamic_mate(const hm_dynamic<double> *);
+template bool hm_dynamic_update_row(hm_dynamic<int32_t> *, int,
+                                    const int32_t *);
+template bool hm_dynamic_update_row(hm_dynamic<int64_t> *, int,
+                                    const int64_t *);
+template bool hm_dynamic_update_row(hm_dynamic<float> *, int, const float *);
+template bool hm_dynamic_update_row(hm_dynamic<double> *, int, const double *);
+template bool hm_dynamic_update_col(hm_dynamic<int32_t> *, int,
+                                    const int32_t *);
+template bool hm_dynamic_update_col(hm_dynamic<int64_t> *, int,
+                                    const int64_t *);
+template bool hm_dynamic_update_col(hm_dynamic<float> *, int, const float *);
+template bool hm_dynamic_update_col(hm_dynamic<double> *, int, const double *);
+template bool hm_dynamic_add(hm_dynamic<int32_t> *, const int32_t *,
+                             const int32_t *);
+template bool hm_dynamic_add(hm_dynamic<int64_t> *, const int64_t *,
+                             const int64_t *);
+template bool hm_dynamic_add(hm_dynamic<float> *, const float *, const float *);
+template bool hm_dynamic_add(hm_dynamic<double> *, const double *,
+                             const double *);
+template bool hm_dynamic_remove(hm_dynamic<int32_t> *, int, int);
+template bool hm_dynamic_remove(hm_dynamic<int64_t> *, int, int);
+template bool hm_dynamic_remove(hm_dynamic<float> *, int, int);
+template bool hm_dynamic_remove(hm_dynamic<double> *, int, int);
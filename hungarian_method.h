@@ -15,6 +15,149 @@
 #ifndef HUNGARIAN_METHOD_H
 #define HUNGARIAN_METHOD_H
 
-void hungarian_method(int *, int *, int);
+#include <stdint.h>
+
+// A reusable solver workspace. See hungarian_method.cc.
+typedef struct hm_workspace_ hm_workspace;
+
+hm_workspace *hm_workspace_create(int);
+void hm_workspace_free(hm_workspace *);
+int hm_workspace_max_n(const hm_workspace *);
+
+// Options for workspaces, e.g. to solve large problems on several threads. See
+// hm_workspace_create() in hungarian_method.cc.
+typedef struct hm_options_ hm_options;
+
+// How column minima are computed from the row-major costs: by accumulating
+// them row by row, or by scanning each column in turn.
+enum
+{
+    hm_scan_rows,
+    hm_scan_columns
+};
+
+struct hm_options_
+{
+    int num_threads;        // zero or less for one per hardware thread
+    int parallel_threshold; // the least n solved in parallel
+    int scan;               // hm_scan_rows or hm_scan_columns
+};
+
+void hm_options_init(hm_options *);
+hm_workspace *hm_workspace_create(int, const hm_options *);
+
+// Counts and timings of the last solve with a workspace, kept only when the
+// solver is compiled with HM_STATS defined. See hm_workspace_stats() in
+// hungarian_method.cc.
+typedef struct hm_stats_ hm_stats;
+
+struct hm_stats_
+{
+    int64_t stages;         // stages run, one per augmentation
+    int64_t searches;       // search sub-stages run
+    int64_t modifies;       // dual updates by "procedure modify"
+    int64_t arcs;           // arcs added to the auxiliary graph
+    int64_t augmentations;  // augmenting paths applied
+    int64_t path_edges;     // the total length of those paths, in edges
+    int64_t max_path_edges; // the length of the longest of them
+    double initialize_seconds;
+    double construct_seconds;
+    double search_seconds; // including augmentations
+    double modify_seconds;
+};
+
+const hm_stats *hm_workspace_stats(const hm_workspace *);
+
+// The solver is compiled for int32_t, int64_t, float, and double costs.
+template <typename T>
+void hungarian_method(int *, const T *, int);
+template <typename T>
+bool hungarian_method(hm_workspace *, int *, const T *, int);
+
+// The objective senses of hungarian_method().
+enum
+{
+    hm_minimize,
+    hm_maximize
+};
+
+template <typename T>
+bool hungarian_method(hm_workspace *, int *, const T *, int, int);
+
+// The cost and optimal duals of a solve, filled in by the overload below. See
+// hungarian_method() in hungarian_method.cc.
+template <typename T>
+struct hm_solution
+{
+    T cost;         // the cost of the matching found, if cost_fits
+    T *alpha;       // receives the n duals of V, unless NULL
+    T *beta;        // receives the n duals of U, unless NULL
+    bool cost_fits; // false if that cost lies outside the range of T
+};
+
+template <typename T>
+bool hungarian_method(hm_workspace *, int *, const T *, int, int,
+                      hm_solution<T> *);
+
+// The wide mode, with 64-bit duals over 32-bit costs of any magnitude. See
+// hungarian_method.cc.
+bool hungarian_method_wide(hm_workspace *, int *, const int32_t *, int);
+void hungarian_method_wide(int *, const int32_t *, int);
+
+// A bounded mode, which stops early once every matching provably costs more
+// than a budget, or when a time or stage limit is reached. See
+// hungarian_method_bounded() in hungarian_method.cc.
+typedef struct hm_limits_ hm_limits;
+
+struct hm_limits_
+{
+    double seconds; // the wall-clock limit, or zero or less for none
+    int max_stages; // the stage limit, or zero or less for none
+};
+
+// The outcomes of hungarian_method_bounded().
+enum
+{
+    hm_status_optimal,     // mate is optimal and within the budget
+    hm_status_over_budget, // every matching costs more than the budget
+    hm_status_time_limit,  // the time limit was reached first
+    hm_status_stage_limit, // the stage limit was reached first
+    hm_status_too_large,   // n exceeds the capacity of the workspace
+    hm_status_out_of_range // the bound lies below the range of the cost type
+};
+
+void hm_limits_init(hm_limits *);
+template <typename T>
+int hungarian_method_bounded(hm_workspace *, int *, const T *, int, T,
+                             const hm_limits *, T *);
+
+// Warm-started variants, which repair and continue from a previous matching and
+// duals. See hungarian_method.cc.
+template <typename T>
+bool hungarian_method_warm(hm_workspace *, int *, T *, T *, const T *, int);
+template <typename T>
+bool hungarian_method_warm(int *, T *, T *, const T *, int);
+
+// A persistent solver that restores the optimum after a change to one row or
+// one column in a single stage. See hungarian_method.cc.
+template <typename T>
+struct hm_dynamic;
+
+template <typename T>
+hm_dynamic<T> *hm_dynamic_create(const T *, int, int);
+template <typename T>
+void hm_dynamic_free(hm_dynamic<T> *);
+template <typename T>
+int hm_dynamic_n(const hm_dynamic<T> *);
+template <typename T>
+const int *hm_dynamic_mate(const hm_dynamic<T> *);
+template <typename T>
+bool hm_dynamic_update_row(hm_dynamic<T> *, int, const T *);
+template <typename T>
+bool hm_dynamic_update_col(hm_dynamic<T> *, int, const T *);
+template <typename T>
+bool hm_dynamic_add(hm_dynamic<T> *, const T *, const T *);
+template <typename T>
+bool hm_dynamic_remove(hm_dynamic<T> *, int, int);
 
 #endif
@@ -0,0 +1,148 @@
+// Copyright 2010, 2017 William Rummler (w.a.rummler@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <http://www.gnu.org/licenses/>.
+
+// This file contains a shortest augmenting path solver for the assignment
+// problem in the style of Jonker and Volgenant, "A Shortest Augmenting Path
+// Algorithm for Dense and Sparse Linear Assignment Problems", Computing 38
+// (1987), pages 325--340. It is offered as a production alternative to the
+// didactic implementation in hungarian_method.cc, which it must agree with.
+//
+// The solver starts from the column reduction of JV's initialization phase and
+// then, for each row left unassigned, grows a Dijkstra shortest path tree over
+// the reduced costs until it reaches an unassigned column, updates the dual
+// variables along the tree, and augments. Each augmentation costs O(n^2), so
+// the whole solve is O(n^3) regardless of the cost values.
+//
+// Rectangular n*m problems are solved directly, without padding to a square.
+// The solver always augments from the smaller side, reading the cost matrix
+// transposed when n > m, so an n*m solve takes O(min(n,m)^2 max(n,m)) time.
+// Columns left unassigned keep their initial dual of zero while the duals of
+// assigned columns only decrease, which is exactly the optimality condition of
+// the rectangular problem. The column reduction is used for square problems
+// only, since it would give unassigned columns unequal duals.
+//
+// The solver itself is in jonker_volgenant_core.h, templated on how it reads
+// costs, and is shared with hm_oracle_solve(). This file reads them from the
+// caller's matrix.
+
+#include "jonker_volgenant.h"
+#include "jonker_volgenant_core.h"
+#include <cstdlib>
+
+// The costs of the caller's matrix, as read by the solver of
+// jonker_volgenant_core.h. Strides allow rows to be the columns of the
+// caller's matrix.
+struct jv_matrix_row
+{
+    const int *c;
+    size_t cs; // the distance in c between adjacent columns
+
+    int operator[](int j) const
+    {
+        return c[(size_t)j * cs];
+    }
+};
+
+struct jv_matrix
+{
+    typedef jv_matrix_row row_type;
+
+    const int *c;
+    size_t rs; // the distance in c between adjacent rows
+    size_t cs;
+
+    row_type row(int i) const
+    {
+        row_type r = { c + (size_t)i * rs, cs };
+        return r;
+    }
+};
+
+// Input:
+//
+// mate points to a memory block of at least n + m ints. It is used to represent
+// and return the solution matching.
+//
+// c points to a memory block of at least n * m ints. It contains the n*m cost
+// matrix c[ 0...n-1 ][ 0...m-1 ] that implicitly defines the complete bipartite
+// graph G=(V,U,E). Unlike hungarian_method(), c is never written to.
+//
+// n is the size of V and m is the size of U.
+//
+// Output:
+//
+// Fills mate with a minimum cost matching of size min(n,m), where V={0,...,n-1}
+// and U={n,...,n+m-1}. An edge (v,u) is part of the matching if and only if
+// (v,mate[v])=(mate[u],u), and mate[w] is negative for each vertex w of the
+// larger side left unmatched. Returns with mate untouched if memory is
+// unavailable.
+void jonker_volgenant(int *mate, const int *c, int n, int m)
+{
+    // Solve with the smaller side as the rows. When that is U, mate[] is built
+    // internally with the parts exchanged and translated at the end.
+    jv_data<jv_matrix> jv;
+    bool transposed = n > m;
+    jv.costs.c = c;
+    jv.costs.rs = transposed ? 1 : m;
+    jv.costs.cs = transposed ? m : 1;
+    jv.n = transposed ? m : n;
+    jv.m = transposed ? n : m;
+
+    // Allocate the internal data structures as one block.
+    size_t size = jv_size(jv.n, jv.m);
+    if (transposed)
+    {
+        size += (size_t)n + m;
+    }
+
+    int *p = (int *)malloc(size * sizeof(*p));
+    if (!p)
+    {
+        return;
+    }
+
+    jv_bind(&jv, p);
+    jv.mate = transposed ? p + jv_size(jv.n, jv.m) : mate;
+    jv_solve(&jv);
+
+    // Row i of the transposed problem is vertex n + i of U, and column j is
+    // vertex j of V.
+    int i, j;
+    if (transposed)
+    {
+        for (i = 0; i < m; ++i)
+        {
+            j = jv.mate[i] - m;
+            mate[n + i] = j;
+            mate[j] = n + i;
+        }
+
+        for (j = 0; j < n; ++j)
+        {
+            if (jv.mate[m + j] == jv_blank)
+            {
+                mate[j] = jv_blank;
+            }
+        }
+    }
+
+    free(p);
+}
+
+// As above, for the square case n = m. Fills mate exactly as hungarian_method()
+// does.
+void jonker_volgenant(int *mate, const int *c, int n)
+{
+    jonker_volgenant(mate, c, n, n);
+}
@@ -0,0 +1,245 @@
+// Copyright 2010, 2017 William Rummler (w.a.rummler@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef JONKER_VOLGENANT_CORE_H
+#define JONKER_VOLGENANT_CORE_H
+
+// The shortest augmenting path solver of jonker_volgenant.cc, templated on how
+// it reads costs, so that one solver serves both the cost matrices of
+// jonker_volgenant() and the cost functors of hm_oracle_solve(). It is defined
+// here rather than in jonker_volgenant.cc so that the reads are inlined into
+// its loops. See jonker_volgenant.cc for the method.
+//
+// The accessor type A defines a type A::row_type and a member function row(i)
+// returning row i of the costs as an A::row_type r, whose costs are read as
+// r[j] for each column j. A row is read only until row() is next called.
+
+#include <stddef.h>
+
+// A negative int as a "blank" value, as in hungarian_method.cc.
+enum
+{
+    jv_blank = -1
+};
+
+// Convenience macros in the spirit of those in hungarian_method.cc. Rows are
+// indexed by i in {0,...,n-1} and columns by j in {0,...,m-1}, so that ROW(j)
+// and COL(i) translate between the two parts of mate[]. They are undefined at
+// the end of this file.
+#define COL(i_) (jv->mate[(i_)])
+#define ROW(j_) (jv->mate[jv->n + (j_)])
+
+// This structure type holds all data pertinent to the solver.
+template <typename A>
+struct jv_data
+{
+    int *mate;
+    A costs;
+    int n; // the number of rows, where n <= m
+    int m; // the number of columns
+
+    // Allocated by the caller, as one block carved by jv_bind().
+    int *u;    // row duals
+    int *v;    // column duals
+    int *d;    // shortest path distances to columns
+    int *pred; // the row preceding each column on its shortest path
+    int *todo; // columns not yet scanned, followed by those that have been
+};
+
+// Returns the number of ints jv_bind() carves for n rows and m columns. One
+// extra int keeps malloc() from returning NULL when n and m are zero.
+static inline size_t jv_size(int n, int m)
+{
+    return (size_t)n + 4 * (size_t)m + 1;
+}
+
+// Carves the arrays of jv, whose n and m are set, out of the block p of
+// jv_size() ints.
+template <typename A>
+static void jv_bind(jv_data<A> *jv, int *p)
+{
+    jv->u = p;
+    jv->v = (p += jv->n);
+    jv->d = (p += jv->m);
+    jv->pred = (p += jv->m);
+    jv->todo = p + jv->m;
+}
+
+// Assigns row i to column j, where j is an index into {0,...,m-1}.
+template <typename A>
+static inline void jv_assign(jv_data<A> *jv, int i, int j)
+{
+    COL(i) = jv->n + j;
+    ROW(j) = i;
+}
+
+// JV's column reduction: each column's dual is its minimum cost, and a column
+// is assigned to the row attaining that minimum when the row is still free.
+// Rows start with zero duals, which keeps every reduced cost non-negative and
+// every assigned edge tight. For rectangular problems, every dual starts at
+// zero instead and every row and column is left free.
+template <typename A>
+static void jv_column_reduction(jv_data<A> *jv)
+{
+    int i, j, imin, n = jv->n, m = jv->m;
+    for (i = 0; i < n; ++i)
+    {
+        COL(i) = jv_blank;
+        jv->u[i] = 0;
+    }
+
+    if (n < m)
+    {
+        for (j = 0; j < m; ++j)
+        {
+            ROW(j) = jv_blank;
+            jv->v[j] = 0;
+        }
+
+        return;
+    }
+
+    // Accumulate the column minima, and the first row attaining each, one row
+    // at a time, so that the row-major costs are read sequentially.
+    typename A::row_type row = jv->costs.row(0);
+    for (j = 0; j < m; ++j)
+    {
+        ROW(j) = jv_blank;
+        jv->v[j] = row[j];
+        jv->pred[j] = 0;
+    }
+
+    for (i = 1; i < n; ++i)
+    {
+        row = jv->costs.row(i);
+        for (j = 0; j < m; ++j)
+        {
+            int c = row[j];
+            if (c < jv->v[j])
+            {
+                jv->v[j] = c;
+                jv->pred[j] = i;
+            }
+        }
+    }
+
+    for (j = n - 1; j >= 0; --j)
+    {
+        imin = jv->pred[j];
+        if (COL(imin) == jv_blank)
+        {
+            jv_assign(jv, imin, j);
+        }
+    }
+}
+
+// Grows a shortest path tree from the free row f over the reduced costs c(i,j)
+// - u[i] - v[j], updates the duals so that the tree's edges become tight, and
+// augments the matching along the path found to a free column. Each row's
+// costs are read only for the columns still unscanned.
+template <typename A>
+static void jv_augment(jv_data<A> *jv, int f)
+{
+    int i, j, k, t, mu, dk, last, n = jv->n, m = jv->m;
+
+    // todo[0...scanned-1] holds the scanned columns in the order they were
+    // scanned, and todo[scanned...m-1] holds the rest.
+    int scanned = 0;
+    typename A::row_type row = jv->costs.row(f);
+    for (j = 0; j < m; ++j)
+    {
+        jv->todo[j] = j;
+        jv->d[j] = row[j] - jv->u[f] - jv->v[j];
+        jv->pred[j] = f;
+    }
+
+    for (;;)
+    {
+        // Scan the closest unscanned column.
+        for (t = k = scanned; k < m; ++k)
+        {
+            if (jv->d[jv->todo[k]] < jv->d[jv->todo[t]])
+            {
+                t = k;
+            }
+        }
+
+        j = jv->todo[t];
+        jv->todo[t] = jv->todo[scanned];
+        jv->todo[scanned++] = j;
+        mu = jv->d[j];
+        if (ROW(j) == jv_blank)
+        {
+            break;
+        }
+
+        // Relax the edges leaving the row assigned to that column.
+        i = ROW(j);
+        row = jv->costs.row(i);
+        for (k = scanned; k < m; ++k)
+        {
+            t = jv->todo[k];
+            dk = mu + row[t] - jv->u[i] - jv->v[t];
+            if (dk < jv->d[t])
+            {
+                jv->d[t] = dk;
+                jv->pred[t] = i;
+            }
+        }
+    }
+
+    // Update the duals. Every scanned column k is at distance d[k] <= mu, and
+    // shifting v[k] down and u[ROW(k)] up by mu - d[k] keeps assigned edges
+    // tight while making every edge of the path tight as well.
+    last = j;
+    jv->u[f] += mu;
+    for (k = 0; k < scanned - 1; ++k)
+    {
+        t = jv->todo[k];
+        jv->v[t] -= mu - jv->d[t];
+        jv->u[ROW(t)] += mu - jv->d[t];
+    }
+
+    // Augment along the alternating path ending at the free column last.
+    j = last;
+    do
+    {
+        i = jv->pred[j];
+        k = COL(i) == jv_blank ? jv_blank : COL(i) - n;
+        jv_assign(jv, i, j);
+        j = k;
+    } while (i != f);
+}
+
+// Solves jv, whose mate, costs, n, and m are set and whose arrays are bound:
+// initializes, then augments from each row the column reduction left free.
+template <typename A>
+static void jv_solve(jv_data<A> *jv)
+{
+    int i;
+    jv_column_reduction(jv);
+    for (i = 0; i < jv->n; ++i)
+    {
+        if (COL(i) == jv_blank)
+        {
+            jv_augment(jv, i);
+        }
+    }
+}
+
+#undef COL
+#undef ROW
+
+#endif
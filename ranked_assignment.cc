@@ -0,0 +1,396 @@
+// Copyright 2010, 2017 William Rummler (w.a.rummler@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <http://www.gnu.org/licenses/>.
+
+// This file contains an enumeration of assignments in order of increasing cost,
+// after Murty, "An Algorithm for Ranking all the Assignments in Order of
+// Increasing Cost", Operations Research 16 (1968), pages 682--687.
+//
+// The assignments are partitioned into subsets, each defined by edges forced
+// into the matching and edges forbidden from it, and each paired with its own
+// optimal assignment. A priority queue holds the subsets by the cost of that
+// assignment, so the subset at its head holds the next assignment in order.
+// Once that assignment is reported, its subset is split by its edges not yet
+// forced, (i_1,j_1), ..., (i_r,j_r): the t-th child forces the edges before
+// (i_t,j_t) and forbids (i_t,j_t) itself, and the children are queued.
+//
+// A child differs from its parent only by one forbidden edge and a few forced
+// ones, which merely raise costs. The parent's duals therefore stay feasible
+// for the child and its matching stays tight everywhere but on the forbidden
+// edge, so hungarian_method_warm() solves each child from the parent's solution
+// in a single stage, O(n^2), rather than the n stages of a solve from scratch.
+//
+// Forcing and forbidding are expressed through the costs themselves: every
+// excluded edge costs M, which exceeds the cost of any assignment avoiding such
+// edges. A child whose optimal assignment still uses one has no assignment at
+// all, and is dropped. The costs are widened to int64_t, so that neither M nor
+// the doubled costs of the solver can overflow.
+
+#include "ranked_assignment.h"
+#include "hungarian_method.h"
+#include <cstdlib>
+#include <cstring>
+
+// A subset of the assignments, with its optimal assignment.
+typedef struct ra_node_ ra_node;
+
+struct ra_node_
+{
+    int64_t cost;      // the cost of mate under the caller's costs
+    int num_forbidden; // the number of edges forbidden
+
+    // Allocated as one block with the node.
+    int *mate;       // the optimal assignment of the subset, as 2n ints
+    int64_t *beta;   // its duals of U
+    int *forced;     // the column forced on each row, or -1 if none
+    int *forbidden;  // the edges forbidden, as pairs (i, j)
+};
+
+struct ranked_assignment_
+{
+    const int32_t *c;
+    int n;
+    int64_t big;       // the cost M of an excluded edge
+    hm_workspace *ws;
+    int64_t *w;        // the costs of the subset being split, n*n
+    int64_t *alpha;    // scratch duals of V
+    ra_node **heap;    // a binary min-heap of subsets, keyed on cost
+    int heap_size;
+    int heap_capacity;
+};
+
+// Returns a node with room for the given number of forbidden edges, or NULL if
+// memory is unavailable.
+static ra_node *ra_node_create(int n, int num_forbidden)
+{
+    size_t size = sizeof(ra_node) + (size_t)n * sizeof(int64_t)
+        + (3 * (size_t)n + 2 * (size_t)num_forbidden) * sizeof(int);
+    ra_node *node = (ra_node *)malloc(size);
+    if (!node)
+    {
+        return NULL;
+    }
+
+    // The int64_t duals come first, so that they are suitably aligned.
+    node->num_forbidden = num_forbidden;
+    node->beta = (int64_t *)(node + 1);
+    node->mate = (int *)(node->beta + n);
+    node->forced = node->mate + 2 * n;
+    node->forbidden = node->forced + n;
+    return node;
+}
+
+// Queues node, or frees it and returns false if memory is unavailable.
+static bool ra_push(ranked_assignment *ra, ra_node *node)
+{
+    if (ra->heap_size == ra->heap_capacity)
+    {
+        int capacity = ra->heap_capacity ? 2 * ra->heap_capacity : 16;
+        ra_node **heap = (ra_node **)realloc(ra->heap,
+                                             capacity * sizeof(*heap));
+        if (!heap)
+        {
+            free(node);
+            return false;
+        }
+
+        ra->heap = heap;
+        ra->heap_capacity = capacity;
+    }
+
+    int h = ra->heap_size++, parent;
+    while (h > 0 && ra->heap[parent = (h - 1) / 2]->cost > node->cost)
+    {
+        ra->heap[h] = ra->heap[parent];
+        h = parent;
+    }
+
+    ra->heap[h] = node;
+    return true;
+}
+
+// Removes and returns the least costly queued node.
+static ra_node *ra_pop(ranked_assignment *ra)
+{
+    ra_node *top = ra->heap[0], *last = ra->heap[--ra->heap_size];
+    int h = 0, child;
+    while ((child = 2 * h + 1) < ra->heap_size)
+    {
+        if (child + 1 < ra->heap_size
+            && ra->heap[child + 1]->cost < ra->heap[child]->cost)
+        {
+            ++child;
+        }
+
+        if (ra->heap[child]->cost >= last->cost)
+        {
+            break;
+        }
+
+        ra->heap[h] = ra->heap[child];
+        h = child;
+    }
+
+    ra->heap[h] = last;
+    return top;
+}
+
+// Excludes every edge of row i and column j but (i,j) itself from w.
+static void ra_force(ranked_assignment *ra, int i, int j)
+{
+    int k, n = ra->n;
+    for (k = 0; k < n; ++k)
+    {
+        if (k != j)
+        {
+            ra->w[(size_t)i * n + k] = ra->big;
+        }
+
+        if (k != i)
+        {
+            ra->w[(size_t)k * n + j] = ra->big;
+        }
+    }
+}
+
+// Solves the subset node, whose mate and beta hold a starting solution, against
+// the costs w. Returns false if the subset has no assignment.
+static bool ra_solve(ranked_assignment *ra, ra_node *node)
+{
+    int i, j, n = ra->n;
+    hungarian_method_warm(ra->ws, node->mate, ra->alpha, node->beta, ra->w, n);
+    node->cost = 0;
+    for (i = 0; i < n; ++i)
+    {
+        j = node->mate[i] - n;
+        if (ra->w[(size_t)i * n + j] >= ra->big)
+        {
+            return false;
+        }
+
+        node->cost += ra->c[(size_t)i * n + j];
+    }
+
+    return true;
+}
+
+// Splits the subset node, which has just been reported, into its children and
+// queues those that have an assignment. Returns false if memory is unavailable.
+static bool ra_split(ranked_assignment *ra, ra_node *node)
+{
+    int i, j, k, n = ra->n, num_free = 0;
+    size_t e, size = (size_t)n * n;
+    for (e = 0; e < size; ++e)
+    {
+        ra->w[e] = ra->c[e];
+    }
+
+    for (k = 0; k < node->num_forbidden; ++k)
+    {
+        ra->w[(size_t)node->forbidden[2 * k] * n
+              + node->forbidden[2 * k + 1]] = ra->big;
+    }
+
+    for (i = 0; i < n; ++i)
+    {
+        if (node->forced[i] >= 0)
+        {
+            ra_force(ra, i, node->forced[i]);
+        }
+        else
+        {
+            ++num_free;
+        }
+    }
+
+    // Forbidding the last free edge while forcing all the others would leave
+    // no assignment, so that child is never solved.
+    for (i = 0; i < n && num_free > 1; ++i)
+    {
+        if (node->forced[i] >= 0)
+        {
+            continue;
+        }
+
+        ra_node *child = ra_node_create(n, node->num_forbidden + 1);
+        if (!child)
+        {
+            return false;
+        }
+
+        j = node->mate[i] - n;
+        memcpy(child->mate, node->mate, 2 * n * sizeof(int));
+        memcpy(child->beta, node->beta, n * sizeof(int64_t));
+        memcpy(child->forced, node->forced, n * sizeof(int));
+        memcpy(child->forbidden, node->forbidden,
+               2 * node->num_forbidden * sizeof(int));
+        child->forbidden[2 * node->num_forbidden] = i;
+        child->forbidden[2 * node->num_forbidden + 1] = j;
+
+        ra->w[(size_t)i * n + j] = ra->big;
+        if (!ra_solve(ra, child))
+        {
+            free(child);
+        }
+        else if (!ra_push(ra, child))
+        {
+            return false;
+        }
+
+        // Restore the edge and force it for the children that follow.
+        ra->w[(size_t)i * n + j] = ra->c[(size_t)i * n + j];
+        ra_force(ra, i, j);
+        node->forced[i] = j;
+        --num_free;
+    }
+
+    return true;
+}
+
+void ranked_assignment_free(ranked_assignment *ra)
+{
+    if (ra)
+    {
+        while (ra->heap_size > 0)
+        {
+            free(ra_pop(ra));
+        }
+
+        free(ra->heap);
+        free(ra->w);
+        free(ra->alpha);
+        hm_workspace_free(ra->ws);
+        free(ra);
+    }
+}
+
+// Input:
+//
+// c points to the n*n cost matrix, as described for hungarian_method(). It is
+// read until the enumeration is freed, and must not change meanwhile.
+//
+// Output:
+//
+// Returns an enumeration positioned before the least costly assignment, having
+// found that assignment, or NULL if memory is unavailable.
+ranked_assignment *ranked_assignment_create(const int32_t *c, int n)
+{
+    ranked_assignment *ra = (ranked_assignment *)calloc(1, sizeof(*ra));
+    if (!ra || n < 0)
+    {
+        free(ra);
+        return NULL;
+    }
+
+    // An assignment avoiding excluded edges costs at most n * cmax, and one
+    // using them at least M + (n - 1) * cmin.
+    int k;
+    size_t e, size = (size_t)n * n;
+    int64_t cmin = 0, cmax = 0;
+    for (e = 0; e < size; ++e)
+    {
+        if (!e || c[e] < cmin)
+        {
+            cmin = c[e];
+        }
+
+        if (!e || c[e] > cmax)
+        {
+            cmax = c[e];
+        }
+    }
+
+    ra->c = c;
+    ra->n = n;
+    ra->big = n * (cmax - cmin) + cmin + 1;
+    ra->ws = hm_workspace_create(n);
+    ra->w = (int64_t *)malloc((size + 1) * sizeof(*ra->w));
+    ra->alpha = (int64_t *)malloc((n + 1) * sizeof(*ra->alpha));
+    ra_node *root = ra_node_create(n, 0);
+    if (!ra->ws || !ra->w || !ra->alpha || !root)
+    {
+        free(root);
+        ranked_assignment_free(ra);
+        return NULL;
+    }
+
+    // The root is the set of all assignments, solved from scratch.
+    for (e = 0; e < size; ++e)
+    {
+        ra->w[e] = c[e];
+    }
+
+    for (k = 0; k < n; ++k)
+    {
+        root->mate[k] = root->mate[n + k] = -1;
+        root->beta[k] = 0;
+        root->forced[k] = -1;
+    }
+
+    ra_solve(ra, root);
+    if (!ra_push(ra, root))
+    {
+        ranked_assignment_free(ra);
+        return NULL;
+    }
+
+    return ra;
+}
+
+// Fills mate, as hungarian_method() does, with the next assignment in order of
+// increasing cost, and sets *cost to its cost. Ties are reported in no fixed
+// order. Returns false, leaving mate and *cost untouched, once every assignment
+// has been reported, or if memory is unavailable, after which the enumeration
+// may only be freed.
+bool ranked_assignment_next(ranked_assignment *ra, int *mate, int64_t *cost)
+{
+    if (!ra->heap_size)
+    {
+        return false;
+    }
+
+    ra_node *node = ra_pop(ra);
+    bool ok = ra_split(ra, node);
+    if (ok)
+    {
+        memcpy(mate, node->mate, 2 * ra->n * sizeof(int));
+        *cost = node->cost;
+    }
+
+    free(node);
+    return ok;
+}
+
+// Fills mates with the k least costly assignments of the n*n costs c, in order,
+// each as 2n ints as hungarian_method() fills mate, and costs with their costs.
+// Returns the number of assignments found, which is less than k only if there
+// are fewer or memory is unavailable.
+int k_best_assignments(int *mates, int64_t *costs, const int32_t *c, int n,
+                       int k)
+{
+    int count = 0;
+    ranked_assignment *ra = ranked_assignment_create(c, n);
+    if (!ra)
+    {
+        return 0;
+    }
+
+    while (count < k && ranked_assignment_next(ra, mates + (size_t)count * 2 * n,
+                                               costs + count))
+    {
+        ++count;
+    }
+
+    ranked_assignment_free(ra);
+    return count;
+}
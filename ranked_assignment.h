@@ -0,0 +1,30 @@
+// Copyright 2010, 2017 William Rummler (w.a.rummler@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef RANKED_ASSIGNMENT_H
+#define RANKED_ASSIGNMENT_H
+
+#include <stdint.h>
+
+// An enumeration of the assignments of a cost matrix in order of increasing
+// cost. See ranked_assignment.cc.
+typedef struct ranked_assignment_ ranked_assignment;
+
+ranked_assignment *ranked_assignment_create(const int32_t *, int);
+void ranked_assignment_free(ranked_assignment *);
+bool ranked_assignment_next(ranked_assignment *, int *, int64_t *);
+
+int k_best_assignments(int *, int64_t *, const int32_t *, int, int);
+
+#endif
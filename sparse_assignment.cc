@@ -0,0 +1,293 @@
+// Copyright 2010, 2017 William Rummler (w.a.rummler@gmail.com)
+//
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation, either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program. If not, see <http://www.gnu.org/licenses/>.
+
+// This file contains a shortest augmenting path solver for assignment problems
+// on incomplete bipartite graphs, given as a sparse cost matrix in compressed
+// sparse row (CSR) form. It follows jonker_volgenant.cc, of which it is the
+// sparse counterpart, but grows each shortest path tree with a binary heap and
+// touches only the edges leaving the rows it reaches. An augmentation therefore
+// costs O(E log m) for E edges rather than O(nm), and the state it touches is
+// reset in time proportional to the work done, not to n or m.
+//
+// When the graph has no matching of every row, some shortest path tree exhausts
+// the reachable columns without finding a free one, and the solver reports the
+// problem as infeasible.
+
+#include "sparse_assignment.h"
+#include <cstdlib>
+#include <limits.h>
+
+// The same zero-based conventions as hungarian_method.cc: V={0,...,n-1},
+// U={n,...,n+m-1}, and a negative int as a "blank" value.
+enum
+{
+    blank = -1
+};
+
+// The scan state of a column during one augmentation.
+enum
+{
+    untouched = 0,
+    queued,
+    scanned
+};
+
+// Convenience macros in the spirit of those in jonker_volgenant.cc.
+#define COL(i_) (sa->mate[(i_)])
+#define ROW(j_) (sa->mate[sa->n + (j_)])
+
+typedef struct sa_data_ sa_data;
+
+// This structure type holds all data pertinent to the solver.
+struct sa_data_
+{
+    // Allocated and/or defined by the caller of sparse_assignment().
+    int *mate;
+    const int *row_start;
+    const int *col;
+    const int *cost;
+    int n;
+    int m;
+
+    // Allocated internally, as one block.
+    int *u;       // row duals
+    int *v;       // column duals
+    int *d;       // shortest path distances to columns
+    int *pred;    // the row preceding each column on its shortest path
+    int *state;   // each column's scan state
+    int *touched; // the columns whose state is not untouched, in that order
+    int *heap;    // a binary min-heap of queued columns, keyed on d[]
+    int *pos;     // each queued column's index in heap[]
+    int heap_size;
+    int num_touched;
+};
+
+// Restores the heap property upward from heap index h.
+static void heap_up(sa_data *sa, int h)
+{
+    int j = sa->heap[h], parent;
+    while (h > 0 && sa->d[sa->heap[parent = (h - 1) / 2]] > sa->d[j])
+    {
+        sa->heap[h] = sa->heap[parent];
+        sa->pos[sa->heap[h]] = h;
+        h = parent;
+    }
+
+    sa->heap[h] = j;
+    sa->pos[j] = h;
+}
+
+// Removes and returns the queued column closest to the tree's root.
+static int heap_pop(sa_data *sa)
+{
+    int top = sa->heap[0], j, h = 0, child;
+    j = sa->heap[--sa->heap_size];
+    while ((child = 2 * h + 1) < sa->heap_size)
+    {
+        if (child + 1 < sa->heap_size &&
+            sa->d[sa->heap[child + 1]] < sa->d[sa->heap[child]])
+        {
+            ++child;
+        }
+
+        if (sa->d[sa->heap[child]] >= sa->d[j])
+        {
+            break;
+        }
+
+        sa->heap[h] = sa->heap[child];
+        sa->pos[sa->heap[h]] = h;
+        h = child;
+    }
+
+    if (sa->heap_size > 0)
+    {
+        sa->heap[h] = j;
+        sa->pos[j] = h;
+    }
+
+    return top;
+}
+
+// Relaxes every edge leaving row i, whose own distance is di.
+static void sa_relax(sa_data *sa, int i, int di)
+{
+    int e, j, dj;
+    for (e = sa->row_start[i]; e < sa->row_start[i + 1]; ++e)
+    {
+        j = sa->col[e];
+        if (sa->state[j] == scanned)
+        {
+            continue;
+        }
+
+        dj = di + sa->cost[e] - sa->u[i] - sa->v[j];
+        if (sa->state[j] == untouched)
+        {
+            sa->state[j] = queued;
+            sa->touched[sa->num_touched++] = j;
+            sa->d[j] = dj;
+            sa->pred[j] = i;
+            sa->heap[sa->heap_size] = j;
+            heap_up(sa, sa->heap_size++);
+        }
+        else if (dj < sa->d[j])
+        {
+            sa->d[j] = dj;
+            sa->pred[j] = i;
+            heap_up(sa, sa->pos[j]);
+        }
+    }
+}
+
+// Grows a shortest path tree from the free row f over the reduced costs, and
+// when it reaches a free column, updates the duals as jonker_volgenant.cc does
+// and augments. Returns false if no free column is reachable from f.
+static bool sa_augment(sa_data *sa, int f)
+{
+    int i, j = blank, k, t, mu = 0, last = blank;
+    sa->heap_size = 0;
+    sa->num_touched = 0;
+    sa_relax(sa, f, 0);
+    while (sa->heap_size > 0)
+    {
+        j = heap_pop(sa);
+        sa->state[j] = scanned;
+        mu = sa->d[j];
+        if (ROW(j) == blank)
+        {
+            last = j;
+            break;
+        }
+
+        sa_relax(sa, ROW(j), mu);
+    }
+
+    // Update the duals of the scanned part of the tree, other than last, and
+    // reset the state of every column touched.
+    if (last != blank)
+    {
+        sa->u[f] += mu;
+    }
+
+    for (k = 0; k < sa->num_touched; ++k)
+    {
+        t = sa->touched[k];
+        if (last != blank && sa->state[t] == scanned && t != last)
+        {
+            sa->v[t] -= mu - sa->d[t];
+            sa->u[ROW(t)] += mu - sa->d[t];
+        }
+
+        sa->state[t] = untouched;
+    }
+
+    if (last == blank)
+    {
+        return false;
+    }
+
+    // Augment along the alternating path ending at the free column last.
+    j = last;
+    do
+    {
+        i = sa->pred[j];
+        k = COL(i) == blank ? blank : COL(i) - sa->n;
+        COL(i) = sa->n + j;
+        ROW(j) = i;
+        j = k;
+    } while (i != f);
+
+    return true;
+}
+
+// Input:
+//
+// mate points to a memory block of at least n + m ints. It is used to represent
+// and return the solution matching.
+//
+// row_start, col, and cost give the sparse n*m cost matrix in CSR form. The
+// edges leaving row i are e = row_start[i], ..., row_start[i + 1] - 1, and edge
+// e joins row i to column col[e] at cost cost[e]. Costs may be negative, and
+// none of the arrays is written to.
+//
+// n is the size of V and m is the size of U.
+//
+// Output:
+//
+// Returns true if some matching covers every row, and fills mate with one of
+// minimum cost, where V={0,...,n-1} and U={n,...,n+m-1}. An edge (v,u) is part
+// of the matching if and only if (v,mate[v])=(mate[u],u), and mate[u] is
+// negative for each column u left unmatched.
+//
+// Returns false if no such matching exists (which includes n > m), or if memory
+// is unavailable. In the former case, mate holds a matching of the rows solved
+// before infeasibility was detected; in the latter, mate is untouched.
+bool sparse_assignment(int *mate, const int *row_start, const int *col,
+                       const int *cost, int n, int m)
+{
+    if (n > m)
+    {
+        return false;
+    }
+
+    // Allocate the internal data structures as one block. One extra int keeps
+    // malloc() from returning NULL when n and m are zero.
+    sa_data sa;
+    int *p = (int *)malloc(((size_t)n + 7 * (size_t)m + 1) * sizeof(*p));
+    if (!p)
+    {
+        return false;
+    }
+
+    sa.mate = mate;
+    sa.row_start = row_start;
+    sa.col = col;
+    sa.cost = cost;
+    sa.n = n;
+    sa.m = m;
+    sa.u = p;
+    sa.v = (p += n);
+    sa.d = (p += m);
+    sa.pred = (p += m);
+    sa.state = (p += m);
+    sa.touched = (p += m);
+    sa.heap = (p += m);
+    sa.pos = (p += m);
+
+    // Every dual starts at zero, as in the rectangular case of
+    // jonker_volgenant.cc, so that free columns always share the largest dual.
+    int i, j;
+    for (i = 0; i < n; ++i)
+    {
+        mate[i] = blank;
+        sa.u[i] = 0;
+    }
+
+    for (j = 0; j < m; ++j)
+    {
+        mate[n + j] = blank;
+        sa.v[j] = 0;
+        sa.state[j] = untouched;
+    }
+
+    bool feasible = true;
+    for (i = 0; i < n && feasible; ++i)
+    {
+        feasible = sa_augment(&sa, i);
+    }
+
+    free(sa.u);
+    return feasible;
+}